@@ -18,3 +18,25 @@
  *************************************************************************/
 
 #include "ferenanimation.h"
+
+#include "ferentracerecorder.h"
+
+namespace Feren
+{
+
+    //_________________________________________________________
+    void Animation::updateCurrentTime( int time )
+    {
+        if( !TraceRecorder::enabled() )
+        {
+            QPropertyAnimation::updateCurrentTime( time );
+            return;
+        }
+
+        // animation ticks are recorded per engine. Animations are owned by data objects, themselves owned by engines
+        const QObject* engine( parent() ? parent()->parent():nullptr );
+        const TraceRecorder::Span traceSpan( "animation", engine ? engine->metaObject()->className():"Animation" );
+        QPropertyAnimation::updateCurrentTime( time );
+    }
+
+}
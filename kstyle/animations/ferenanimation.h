@@ -53,6 +53,11 @@ namespace Feren
             start();
         }
 
+        protected:
+
+        //* update current time
+        void updateCurrentTime( int ) override;
+
     };
 
 }
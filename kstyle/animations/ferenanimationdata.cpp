@@ -19,11 +19,19 @@
 
 #include "ferenanimationdata.h"
 
+#include "feren.h"
+
+#include <QCheckBox>
+#include <QRadioButton>
+#include <QStyle>
+#include <QStyleOptionButton>
+
 namespace Feren
 {
 
     const qreal AnimationData::OpacityInvalid = -1;
     int AnimationData::_steps = 0;
+    qint64 AnimationData::_totalRepaintedPixels = 0;
 
     //_________________________________________________________________________________
     void AnimationData::setupAnimation( const Animation::Pointer& animation, const QByteArray& property )
@@ -37,4 +45,75 @@ namespace Feren
 
     }
 
+    //_________________________________________________________________________________
+    void AnimationData::setDirty() const
+    {
+        if( !_target ) return;
+        addRepaintedPixels( _target.data()->rect() );
+        _target.data()->update();
+    }
+
+    //_________________________________________________________________________________
+    void AnimationData::setDirty( const QRegion& region ) const
+    {
+        if( !_target ) return;
+        if( region.isEmpty() ) setDirty();
+        else {
+            addRepaintedPixels( region );
+            _target.data()->update( region );
+        }
+    }
+
+    //_________________________________________________________________________________
+    QRegion AnimationData::dirtyRegion() const
+    {
+        if( !_target ) return QRegion();
+
+        QWidget* widget( _target.data() );
+        switch( _dirtyArea )
+        {
+
+            case DirtyFrame:
+            {
+                // frame outline, including rounded corners
+                const int width( qMax<int>( Metrics::Frame_FrameWidth, Metrics::Frame_FrameRadius ) + 1 );
+                const QRect rect( widget->rect() );
+                const QRect inner( rect.adjusted( width, width, -width, -width ) );
+                if( !inner.isValid() ) return QRegion();
+                return QRegion( rect ) - QRegion( inner );
+            }
+
+            case DirtyIndicator:
+            {
+                QStyle::SubElement element;
+                if( qobject_cast<QCheckBox*>( widget ) ) element = QStyle::SE_CheckBoxIndicator;
+                else if( qobject_cast<QRadioButton*>( widget ) ) element = QStyle::SE_RadioButtonIndicator;
+                else return QRegion();
+
+                QStyleOptionButton option;
+                option.initFrom( widget );
+                const QRect rect( widget->style()->subElementRect( element, &option, widget ) );
+                return QRegion( rect.adjusted(
+                    -Metrics::CheckBox_FocusMarginWidth, -Metrics::CheckBox_FocusMarginWidth,
+                    Metrics::CheckBox_FocusMarginWidth, Metrics::CheckBox_FocusMarginWidth ) );
+            }
+
+            default:
+            case DirtyWidget: return QRegion();
+
+        }
+
+    }
+
+    //_________________________________________________________________________________
+    void AnimationData::addRepaintedPixels( const QRegion& region ) const
+    {
+        qint64 pixels = 0;
+        for( const QRect& rect : region )
+        { pixels += qint64( rect.width() )*rect.height(); }
+
+        _repaintedPixels += pixels;
+        _totalRepaintedPixels += pixels;
+    }
+
 }
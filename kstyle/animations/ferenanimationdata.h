@@ -24,6 +24,7 @@
 
 #include <QEvent>
 #include <QObject>
+#include <QRegion>
 #include <QWidget>
 
 #include <cmath>
@@ -67,6 +68,35 @@ namespace Feren
         //* invalid opacity
         static const qreal OpacityInvalid;
 
+        //* area repainted on each animation step
+        enum DirtyArea
+        {
+            //* full widget
+            DirtyWidget,
+
+            //* frame outline, for input widgets and scroll areas
+            DirtyFrame,
+
+            //* checkbox and radio button indicator
+            DirtyIndicator
+        };
+
+        //* area repainted on each animation step
+        void setDirtyArea( DirtyArea value )
+        { _dirtyArea = value; }
+
+        //* area repainted on each animation step
+        DirtyArea dirtyArea() const
+        { return _dirtyArea; }
+
+        //* number of pixels repainted by this animation so far
+        qint64 repaintedPixels() const
+        { return _repaintedPixels; }
+
+        //* number of pixels repainted by all animations so far
+        static qint64 totalRepaintedPixels()
+        { return _totalRepaintedPixels; }
+
         protected:
 
         //* setup animation
@@ -80,8 +110,18 @@ namespace Feren
         }
 
         //* trigger target update
-        virtual void setDirty() const
-        { if( _target ) _target.data()->update(); }
+        virtual void setDirty() const;
+
+        //* trigger target update, limited to a given region
+        /** falls back to a full update if region is empty */
+        void setDirty( const QRegion& ) const;
+
+        //* region to repaint on animation steps, based on dirty area
+        /** an empty region corresponds to the full widget */
+        virtual QRegion dirtyRegion() const;
+
+        //* account for repainted pixels
+        void addRepaintedPixels( const QRegion& ) const;
 
         private:
 
@@ -91,9 +131,18 @@ namespace Feren
         //* enability
         bool _enabled = true;
 
+        //* area repainted on each animation step
+        DirtyArea _dirtyArea = DirtyWidget;
+
+        //* repainted pixels
+        mutable qint64 _repaintedPixels = 0;
+
         //* steps
         static int _steps;
 
+        //* repainted pixels, for all animations
+        static qint64 _totalRepaintedPixels;
+
     };
 
 }
@@ -92,6 +92,8 @@ namespace Feren
 
         // stacked widget transition has an extra flag for animations
         _stackedWidgetEngine->setEnabled( animationsEnabled && StyleConfigData::stackedWidgetTransitionsEnabled() );
+        _stackedWidgetEngine->setPixelBudget( StyleConfigData::stackedWidgetTransitionPixelBudget() );
+        _stackedWidgetEngine->setMinGrabScale( 0.01*StyleConfigData::stackedWidgetTransitionMinScale() );
 
         // busy indicator
         _busyIndicatorEngine->setEnabled( StyleConfigData::progressBarAnimated() );
@@ -124,7 +126,9 @@ namespace Feren
 
         } else if( qobject_cast<QCheckBox*>(widget) || qobject_cast<QRadioButton*>(widget) ) {
 
-            _widgetStateEngine->registerWidget( widget, AnimationHover|AnimationFocus|AnimationPressed );
+            // hover and pressed only affect the indicator, focus is rendered below the label
+            _widgetStateEngine->registerWidget( widget, AnimationHover|AnimationPressed, AnimationData::DirtyIndicator );
+            _widgetStateEngine->registerWidget( widget, AnimationFocus );
 
         } else if( qobject_cast<QAbstractButton*>(widget) ) {
 
@@ -160,13 +164,13 @@ namespace Feren
         // spinbox
         else if( qobject_cast<QSpinBox*>( widget ) ) {
             _spinBoxEngine->registerWidget( widget );
-            _inputWidgetEngine->registerWidget( widget, AnimationHover|AnimationFocus );
+            _inputWidgetEngine->registerWidget( widget, AnimationHover|AnimationFocus, AnimationData::DirtyFrame );
         }
 
         // editors
-        else if( qobject_cast<QLineEdit*>( widget ) ) { _inputWidgetEngine->registerWidget( widget, AnimationHover|AnimationFocus ); }
-        else if( qobject_cast<QTextEdit*>( widget ) ) { _inputWidgetEngine->registerWidget( widget, AnimationHover|AnimationFocus ); }
-        else if( widget->inherits( "KTextEditor::View" ) ) { _inputWidgetEngine->registerWidget( widget, AnimationHover|AnimationFocus ); }
+        else if( qobject_cast<QLineEdit*>( widget ) ) { _inputWidgetEngine->registerWidget( widget, AnimationHover|AnimationFocus, AnimationData::DirtyFrame ); }
+        else if( qobject_cast<QTextEdit*>( widget ) ) { _inputWidgetEngine->registerWidget( widget, AnimationHover|AnimationFocus, AnimationData::DirtyFrame ); }
+        else if( widget->inherits( "KTextEditor::View" ) ) { _inputWidgetEngine->registerWidget( widget, AnimationHover|AnimationFocus, AnimationData::DirtyFrame ); }
 
         // header views
         // need to come before abstract item view, otherwise is skipped
@@ -174,7 +178,7 @@ namespace Feren
 
         // lists
         else if( qobject_cast<QAbstractItemView*>( widget ) )
-        { _inputWidgetEngine->registerWidget( widget, AnimationHover|AnimationFocus ); }
+        { _inputWidgetEngine->registerWidget( widget, AnimationHover|AnimationFocus, AnimationData::DirtyFrame ); }
 
         // tabbar
         else if( qobject_cast<QTabBar*>( widget ) ) { _tabBarEngine->registerWidget( widget ); }
@@ -183,7 +187,7 @@ namespace Feren
         else if( QAbstractScrollArea* scrollArea = qobject_cast<QAbstractScrollArea*>( widget ) ) {
 
             if( scrollArea->frameShadow() == QFrame::Sunken && (widget->focusPolicy()&Qt::StrongFocus) )
-            { _inputWidgetEngine->registerWidget( widget, AnimationHover|AnimationFocus ); }
+            { _inputWidgetEngine->registerWidget( widget, AnimationHover|AnimationFocus, AnimationData::DirtyFrame ); }
 
         }
 
@@ -213,6 +217,26 @@ namespace Feren
 
     }
 
+    //_______________________________________________________________
+    QHash<const QWidget*, int> Animations::runningAnimations() const
+    {
+
+        QHash<const QWidget*, int> out;
+        foreach( const AnimationData* data, findChildren<AnimationData*>() )
+        {
+            if( !data->target() ) continue;
+
+            int running = 0;
+            foreach( const Animation* animation, data->findChildren<Animation*>( QString(), Qt::FindDirectChildrenOnly ) )
+            { if( animation->isRunning() ) ++running; }
+
+            if( running > 0 ) out[data->target().data()] += running;
+        }
+
+        return out;
+
+    }
+
     //_______________________________________________________________
     void Animations::unregisterEngine( QObject* object )
     {
@@ -30,6 +30,7 @@
 #include "ferentoolboxengine.h"
 #include "ferenwidgetstateengine.h"
 
+#include <QHash>
 #include <QObject>
 #include <QList>
 
@@ -104,6 +105,10 @@ namespace Feren
         //* setup engines
         void setupEngines();
 
+        //* number of running animations, per animated widget
+        /** walks all animation data. Only meant for debugging */
+        QHash<const QWidget*, int> runningAnimations() const;
+
         protected Q_SLOTS:
 
         //* enregister engine
@@ -63,7 +63,7 @@ namespace Feren
             if( _opacity == value ) return;
 
             _opacity = value;
-            setDirty();
+            setDirty( dirtyRegion() );
 
         }
 
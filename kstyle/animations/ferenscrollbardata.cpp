@@ -36,6 +36,10 @@ namespace Feren
 
         target->installEventFilter( this );
 
+        // button rects depend on the scrollbar range
+        if( auto scrollBar = qobject_cast<QScrollBar*>( target ) )
+        { connect( scrollBar, &QAbstractSlider::rangeChanged, this, &ScrollBarData::invalidateButtonRects ); }
+
         _addLineData._animation = new Animation( duration, this );
         _subLineData._animation = new Animation( duration, this );
         _grooveData._animation = new Animation( duration, this );
@@ -71,6 +75,12 @@ namespace Feren
             hoverMoveEvent( object, event );
             break;
 
+            case QEvent::Resize:
+            case QEvent::StyleChange:
+            case QEvent::LayoutDirectionChange:
+            invalidateButtonRects();
+            break;
+
             case QEvent::HoverLeave:
             setGrooveHovered(false);
             grooveAnimation().data()->setDirection( Animation::Backward );
@@ -136,12 +146,12 @@ namespace Feren
         QScrollBar* scrollBar( qobject_cast<QScrollBar*>( object ) );
         if( !scrollBar || scrollBar->isSliderDown() ) return;
 
-        // retrieve scrollbar option
-        QStyleOptionSlider opt( qt_qscrollbarStyleOption( scrollBar ) );
+        // make sure button rects are up to date
+        if( !_buttonRectsValid ) updateButtonRects( scrollBar );
 
         // cast event
         QHoverEvent *hoverEvent = static_cast<QHoverEvent*>(event);
-        QStyle::SubControl hoverControl = scrollBar->style()->hitTestComplexControl(QStyle::CC_ScrollBar, &opt, hoverEvent->pos(), scrollBar);
+        QStyle::SubControl hoverControl = buttonHitTest( hoverEvent->pos() );
 
         // update hover state
         updateAddLineArrow( hoverControl );
@@ -165,6 +175,81 @@ namespace Feren
         _position = QPoint( -1, -1 );
     }
 
+    //______________________________________________
+    void ScrollBarData::updateButtonRects( QWidget* widget )
+    {
+
+        _buttonRects.clear();
+        _buttonRectsValid = true;
+
+        QScrollBar* scrollBar( qobject_cast<QScrollBar*>( widget ) );
+        if( !scrollBar ) return;
+
+        const QStyleOptionSlider opt( qt_qscrollbarStyleOption( scrollBar ) );
+        const QStyle* style( scrollBar->style() );
+        const bool horizontal( opt.orientation == Qt::Horizontal );
+
+        for( const QStyle::SubControl control : { QStyle::SC_ScrollBarSubLine, QStyle::SC_ScrollBarAddLine } )
+        {
+
+            const QRect rect( style->subControlRect( QStyle::CC_ScrollBar, &opt, control, scrollBar ) );
+            if( !rect.isValid() ) continue;
+
+            /*
+             * each end of the scrollbar can hold either one or two buttons.
+             * split it in halves and let the style decide which control each half triggers
+             */
+            QRect first( rect );
+            QRect second( rect );
+            if( horizontal )
+            {
+                first.setWidth( rect.width()/2 );
+                second.setLeft( first.right() + 1 );
+            } else {
+                first.setHeight( rect.height()/2 );
+                second.setTop( first.bottom() + 1 );
+            }
+
+            for( const QRect& half : { first, second } )
+            {
+                if( !half.isValid() ) continue;
+
+                ButtonRect buttonRect;
+                buttonRect._rect = half;
+                buttonRect._control = style->hitTestComplexControl( QStyle::CC_ScrollBar, &opt, half.center(), scrollBar );
+                if( buttonRect._control == QStyle::SC_ScrollBarAddLine || buttonRect._control == QStyle::SC_ScrollBarSubLine )
+                { _buttonRects.append( buttonRect ); }
+            }
+
+        }
+
+    }
+
+    //______________________________________________
+    QStyle::SubControl ScrollBarData::buttonHitTest( const QPoint& position ) const
+    {
+        for( const ButtonRect& buttonRect : _buttonRects )
+        { if( buttonRect._rect.contains( position ) ) return buttonRect._control; }
+
+        return QStyle::SC_None;
+    }
+
+    //______________________________________________
+    QRegion ScrollBarData::buttonRegion( QStyle::SubControl control ) const
+    {
+        if( !_buttonRectsValid ) return QRegion();
+
+        QRegion region;
+        for( const ButtonRect& buttonRect : _buttonRects )
+        {
+            // arrows can be rendered with a one pixel offset
+            if( buttonRect._control == control )
+            { region += buttonRect._rect.adjusted( -1, -1, 1, 1 ); }
+        }
+
+        return region;
+    }
+
     //_____________________________________________________________________
     void ScrollBarData::updateSubLineArrow( QStyle::SubControl hoverControl )
     {
@@ -178,7 +263,7 @@ namespace Feren
                 {
                     subLineAnimation().data()->setDirection( Animation::Forward );
                     if( !subLineAnimation().data()->isRunning() ) subLineAnimation().data()->start();
-                } else setDirty();
+                } else setDirty( buttonRegion( QStyle::SC_ScrollBarSubLine ) );
              }
 
         } else {
@@ -190,7 +275,7 @@ namespace Feren
                 {
                     subLineAnimation().data()->setDirection( Animation::Backward );
                     if( !subLineAnimation().data()->isRunning() ) subLineAnimation().data()->start();
-                } else setDirty();
+                } else setDirty( buttonRegion( QStyle::SC_ScrollBarSubLine ) );
             }
 
         }
@@ -209,7 +294,7 @@ namespace Feren
                 {
                     addLineAnimation().data()->setDirection( Animation::Forward );
                     if( !addLineAnimation().data()->isRunning() ) addLineAnimation().data()->start();
-                } else setDirty();
+                } else setDirty( buttonRegion( QStyle::SC_ScrollBarAddLine ) );
             }
 
         } else {
@@ -221,7 +306,7 @@ namespace Feren
                 {
                     addLineAnimation().data()->setDirection( Animation::Backward );
                     if( !addLineAnimation().data()->isRunning() ) addLineAnimation().data()->start();
-                } else setDirty();
+                } else setDirty( buttonRegion( QStyle::SC_ScrollBarAddLine ) );
             }
 
         }
@@ -23,6 +23,7 @@
 #include "ferenwidgetstatedata.h"
 
 #include <QStyle>
+#include <QVector>
 
 namespace Feren
 {
@@ -112,7 +113,7 @@ namespace Feren
             value = digitize( value );
             if( _addLineData._opacity == value ) return;
             _addLineData._opacity = value;
-            setDirty();
+            setDirty( buttonRegion( QStyle::SC_ScrollBarAddLine ) );
         }
 
         //* addLine opacity
@@ -125,7 +126,7 @@ namespace Feren
             value = digitize( value );
             if( _subLineData._opacity == value ) return;
             _subLineData._opacity = value;
-            setDirty();
+            setDirty( buttonRegion( QStyle::SC_ScrollBarSubLine ) );
         }
 
         //* subLine opacity
@@ -149,6 +150,13 @@ namespace Feren
         QPoint position() const
         { return _position; }
 
+        public Q_SLOTS:
+
+        //* invalidate cached arrow button rects
+        /** needed on resize, range and configuration change */
+        void invalidateButtonRects()
+        { _buttonRectsValid = false; }
+
         protected Q_SLOTS:
 
         //* clear addLineRect
@@ -173,6 +181,15 @@ namespace Feren
         //* hoverMoveEvent
         void hoverLeaveEvent( QObject*, QEvent* );
 
+        //* update cached arrow button rects from scrollbar style
+        void updateButtonRects( QWidget* );
+
+        //* return arrow button subcontrol matching a given position, using cached rects
+        QStyle::SubControl buttonHitTest( const QPoint& ) const;
+
+        //* return region covered by arrow buttons matching a given subcontrol, using cached rects
+        QRegion buttonRegion( QStyle::SubControl ) const;
+
         //*@name hover flags
         //@{
 
@@ -250,6 +267,26 @@ namespace Feren
         //* groove data
         Data _grooveData;
 
+        //* arrow button rect and matching subcontrol
+        class ButtonRect
+        {
+
+            public:
+
+            //* rect
+            QRect _rect;
+
+            //* subcontrol
+            QStyle::SubControl _control = QStyle::SC_None;
+
+        };
+
+        //* cached arrow button rects
+        QVector<ButtonRect> _buttonRects;
+
+        //* true if cached button rects are valid
+        bool _buttonRectsValid = false;
+
         //* mouse position
         QPoint _position;
 
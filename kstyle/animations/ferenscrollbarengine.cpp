@@ -41,6 +41,13 @@ namespace Feren
         return true;
     }
 
+    //____________________________________________________________
+    void ScrollBarEngine::invalidateButtonRects()
+    {
+        foreach( const DataMap<WidgetStateData>::Value& data, dataMap( AnimationHover ) )
+        { if( data ) static_cast<ScrollBarData*>( data.data() )->invalidateButtonRects(); }
+    }
+
     //____________________________________________________________
     bool ScrollBarEngine::isAnimated( const QObject* object, AnimationMode mode, QStyle::SubControl control )
     {
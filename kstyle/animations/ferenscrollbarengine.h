@@ -106,6 +106,10 @@ namespace Feren
             { static_cast<ScrollBarData*>( data.data() )->setSubControlRect( control, rect ); }
         }
 
+        //* invalidate cached arrow button rects for all registered scrollbars
+        /** needed when scrollbar button configuration changes */
+        virtual void invalidateButtonRects();
+
         //@}
 
     };
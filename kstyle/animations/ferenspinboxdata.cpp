@@ -19,6 +19,9 @@
 
 #include "ferenspinboxdata.h"
 
+#include <QAbstractSpinBox>
+#include <QStyleOptionSpinBox>
+
 namespace Feren
 {
 
@@ -32,6 +35,40 @@ namespace Feren
         setupAnimation( downArrowAnimation(), "downArrowOpacity" );
     }
 
+    //______________________________________________
+    void SpinBoxData::setUpArrowOpacity( qreal value )
+    {
+        value = digitize( value );
+        if( _upArrowData._opacity == value ) return;
+        _upArrowData._opacity = value;
+        setDirty( arrowRegion( QStyle::SC_SpinBoxUp ) );
+    }
+
+    //______________________________________________
+    void SpinBoxData::setDownArrowOpacity( qreal value )
+    {
+        value = digitize( value );
+        if( _downArrowData._opacity == value ) return;
+        _downArrowData._opacity = value;
+        setDirty( arrowRegion( QStyle::SC_SpinBoxDown ) );
+    }
+
+    //______________________________________________
+    QRegion SpinBoxData::arrowRegion( QStyle::SubControl subControl ) const
+    {
+        auto spinBox( qobject_cast<QAbstractSpinBox*>( target().data() ) );
+        if( !spinBox ) return QRegion();
+
+        // only the fields used by the style to locate arrows are needed
+        QStyleOptionSpinBox option;
+        option.initFrom( spinBox );
+        option.frame = spinBox->hasFrame();
+        option.buttonSymbols = spinBox->buttonSymbols();
+        option.subControls = QStyle::SC_SpinBoxUp|QStyle::SC_SpinBoxDown;
+
+        return QRegion( spinBox->style()->subControlRect( QStyle::CC_SpinBox, &option, subControl, spinBox ) );
+    }
+
     //______________________________________________
     bool SpinBoxData::Data::updateState( bool value )
     {
@@ -81,13 +81,7 @@ namespace Feren
         { return _upArrowData._opacity; }
 
         //* opacity
-        void setUpArrowOpacity( qreal value )
-        {
-            value = digitize( value );
-            if( _upArrowData._opacity == value ) return;
-            _upArrowData._opacity = value;
-            setDirty();
-        }
+        void setUpArrowOpacity( qreal );
 
         //* animation
         Animation::Pointer upArrowAnimation() const
@@ -103,13 +97,7 @@ namespace Feren
         { return _downArrowData._opacity; }
 
         //* opacity
-        void setDownArrowOpacity( qreal value )
-        {
-            value = digitize( value );
-            if( _downArrowData._opacity == value ) return;
-            _downArrowData._opacity = value;
-            setDirty();
-        }
+        void setDownArrowOpacity( qreal );
 
         //* animation
         Animation::Pointer downArrowAnimation() const
@@ -119,6 +107,10 @@ namespace Feren
 
         private:
 
+        //* region covered by a given arrow, in target coordinates
+        /** empty if the target is not a spinbox, in which case the whole widget gets repainted */
+        QRegion arrowRegion( QStyle::SubControl ) const;
+
         //* container for needed animation data
         class Data
         {
@@ -26,6 +26,8 @@
 
 #include "ferenstackedwidgetdata.h"
 
+#include <cmath>
+
 namespace Feren
 {
 
@@ -75,6 +77,10 @@ namespace Feren
             transition().data()->setOpacity( 0 );
             startClock();
             transition().data()->setGeometry( widget->geometry() );
+
+            // large pages are grabbed and faded at reduced resolution
+            _grabScale = grabScale( widget->size() );
+            transition().data()->setGrabScale( _grabScale );
             transition().data()->setStartPixmap( transition().data()->grab( widget ) );
 
             _index = _target.data()->currentIndex();
@@ -136,4 +142,12 @@ namespace Feren
         _target.clear();
     }
 
+    //___________________________________________________________________
+    qreal StackedWidgetData::grabScale( const QSize& size ) const
+    {
+        const qreal pixels( qreal( size.width() )*size.height() );
+        if( _pixelBudget <= 0 || pixels <= _pixelBudget ) return 1.0;
+        return qBound<qreal>( _minGrabScale, std::sqrt( _pixelBudget/pixels ), 1.0 );
+    }
+
 }
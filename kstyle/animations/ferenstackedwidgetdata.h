@@ -45,6 +45,31 @@ namespace Feren
         //* constructor
         StackedWidgetData( QObject*, QStackedWidget*, int );
 
+        //*@name reduced resolution transitions
+        //@{
+
+        //* number of pixels above which pages are grabbed at reduced resolution. Zero means no limit
+        void setPixelBudget( int value )
+        { _pixelBudget = value; }
+
+        //* number of pixels above which pages are grabbed at reduced resolution
+        int pixelBudget() const
+        { return _pixelBudget; }
+
+        //* smallest scale used for grabbing pages
+        void setMinGrabScale( qreal value )
+        { _minGrabScale = value; }
+
+        //* smallest scale used for grabbing pages
+        qreal minGrabScale() const
+        { return _minGrabScale; }
+
+        //* scale used for the last transition
+        qreal grabScale() const
+        { return _grabScale; }
+
+        //@}
+
         protected Q_SLOTS:
 
         //* initialize animation
@@ -61,12 +86,24 @@ namespace Feren
 
         private:
 
+        //* scale matching pixel budget for a given page size
+        qreal grabScale( const QSize& ) const;
+
         //* target
         WeakPointer<QStackedWidget> _target;
 
         //* current index
         int _index;
 
+        //* pixel budget
+        int _pixelBudget = 0;
+
+        //* smallest grab scale
+        qreal _minGrabScale = 0.25;
+
+        //* scale used for the last transition
+        qreal _grabScale = 1.0;
+
     };
 
 }
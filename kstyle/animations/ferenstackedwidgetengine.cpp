@@ -34,7 +34,13 @@ namespace Feren
     {
 
         if( !widget ) return false;
-        if( !_data.contains( widget ) ) { _data.insert( widget, new StackedWidgetData( this, widget, duration() ), enabled() ); }
+        if( !_data.contains( widget ) )
+        {
+            auto data( new StackedWidgetData( this, widget, duration() ) );
+            data->setPixelBudget( _pixelBudget );
+            data->setMinGrabScale( _minGrabScale );
+            _data.insert( widget, data, enabled() );
+        }
 
         // connect destruction signal
         disconnect( widget, SIGNAL(destroyed(QObject*)), this, SLOT(unregisterWidget(QObject*)) );
@@ -44,4 +50,20 @@ namespace Feren
 
     }
 
+    //____________________________________________________________
+    void StackedWidgetEngine::setPixelBudget( int value )
+    {
+        _pixelBudget = value;
+        foreach( const DataMap<StackedWidgetData>::Value& data, _data )
+        { if( data ) data.data()->setPixelBudget( value ); }
+    }
+
+    //____________________________________________________________
+    void StackedWidgetEngine::setMinGrabScale( qreal value )
+    {
+        _minGrabScale = value;
+        foreach( const DataMap<StackedWidgetData>::Value& data, _data )
+        { if( data ) data.data()->setMinGrabScale( value ); }
+    }
+
 }
@@ -64,6 +64,19 @@ namespace Feren
             _data.setDuration( value );
         }
 
+        //* number of pixels above which pages are grabbed at reduced resolution
+        void setPixelBudget( int );
+
+        //* smallest scale used for grabbing pages
+        void setMinGrabScale( qreal );
+
+        //* scale used for the last transition of a given widget, or 1 if none
+        qreal grabScale( const QObject* object )
+        {
+            const DataMap<StackedWidgetData>::Value data( _data.find( object ) );
+            return data ? data.data()->grabScale() : 1.0;
+        }
+
         public Q_SLOTS:
 
         //* remove widget from map
@@ -72,6 +85,12 @@ namespace Feren
 
         private:
 
+        //* pixel budget
+        int _pixelBudget = 0;
+
+        //* smallest grab scale
+        qreal _minGrabScale = 0.25;
+
         //* maps
         DataMap<StackedWidgetData> _data;
 
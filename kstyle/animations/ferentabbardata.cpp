@@ -56,14 +56,23 @@ namespace Feren
         AnimationData( parent, target )
     {
 
-        _current._animation = new Animation( duration, this );
-        setupAnimation( currentIndexAnimation(), "currentOpacity" );
-        currentIndexAnimation().data()->setDirection( Animation::Forward );
+        _animation = new Animation( duration, this );
+        setupAnimation( _animation, "progress" );
+        _animation.data()->setDirection( Animation::Forward );
 
-        _previous._animation = new Animation( duration, this );
-        setupAnimation( previousIndexAnimation(), "previousOpacity" );
-        previousIndexAnimation().data()->setDirection( Animation::Backward );
+    }
+
+    //______________________________________________
+    void TabBarData::setProgress( qreal value )
+    {
+        // opacities are always updated, since indexes might have changed on restart
+        _progress = value;
 
+        // current tab fades in, previous tab fades out from wherever it was
+        _current._opacity = _current._index >= 0 ? value : 0;
+        _previous._opacity = _previous._index >= 0 ? _previousStartOpacity*( 1.0 - value ) : 0;
+
+        setDirty( tabRegion() );
     }
 
     //______________________________________________
@@ -77,8 +86,7 @@ namespace Feren
 
         int index( local->tabAt( position ) );
         if( index < 0 ) return Animation::Pointer();
-        else if( index == currentIndex() ) return currentIndexAnimation();
-        else if( index == previousIndex() ) return previousIndexAnimation();
+        else if( index == currentIndex() || index == previousIndex() ) return _animation;
         else return Animation::Pointer();
 
     }
@@ -98,28 +106,17 @@ namespace Feren
         if( hovered )
         {
 
-
             if( index != currentIndex() )
             {
 
-                if( currentIndex() >= 0 )
-                {
-                    setPreviousIndex( currentIndex() );
-                    setCurrentIndex( -1 );
-                    previousIndexAnimation().data()->restart();
-                }
-
-                setCurrentIndex( index );
-                currentIndexAnimation().data()->restart();
+                startAnimation( index );
                 return true;
 
             } else return false;
 
         } else if( index == currentIndex() ) {
 
-            setPreviousIndex( currentIndex() );
-            setCurrentIndex( -1 );
-            previousIndexAnimation().data()->restart();
+            startAnimation( -1 );
             return true;
 
         } else return false;
@@ -143,5 +140,44 @@ namespace Feren
 
     }
 
+    //______________________________________________
+    void TabBarData::startAnimation( int index )
+    {
+
+        // tabs dropped from the animation must be repainted once without highlight
+        const QRegion oldRegion( tabRegion() );
+
+        // current tab, if any, becomes previous. Otherwise previous tab keeps fading out
+        if( currentIndex() >= 0 )
+        {
+            setPreviousIndex( currentIndex() );
+            _previousStartOpacity = currentOpacity();
+
+        } else _previousStartOpacity = previousOpacity();
+
+        setCurrentIndex( index );
+        setDirty( oldRegion + tabRegion() );
+        _animation.data()->restart();
+
+    }
+
+    //______________________________________________
+    QRegion TabBarData::tabRegion() const
+    {
+
+        const QTabBar* local( qobject_cast<const QTabBar*>( target().data() ) );
+        if( !local ) return QRegion();
+
+        // add margins for tab outline
+        QRegion region;
+        for( int index : { currentIndex(), previousIndex() } )
+        {
+            if( index < 0 || index >= local->count() ) continue;
+            region += local->tabRect( index ).adjusted( -2, -2, 2, 2 );
+        }
+
+        return region;
+
+    }
 
 }
@@ -33,9 +33,8 @@ namespace Feren
 
         Q_OBJECT
 
-        //* declare opacity property
-        Q_PROPERTY( qreal currentOpacity READ currentOpacity WRITE setCurrentOpacity )
-        Q_PROPERTY( qreal previousOpacity READ previousOpacity WRITE setPreviousOpacity )
+        //* declare progress property
+        Q_PROPERTY( qreal progress READ progress WRITE setProgress )
 
         public:
 
@@ -44,14 +43,31 @@ namespace Feren
 
         //* duration
         void setDuration( int duration ) override
-        {
-            currentIndexAnimation().data()->setDuration( duration );
-            previousIndexAnimation().data()->setDuration( duration );
-        }
+        { _animation.data()->setDuration( duration ); }
 
         //* update state
         bool updateState( const QPoint&, bool );
 
+        //*@name animation progress
+        /**
+        a single animation fades the current tab in and the previous tab out,
+        so that only one repaint of both tabs occurs per step
+        */
+        //@{
+
+        //* progress
+        qreal progress() const
+        { return _progress; }
+
+        //* progress
+        void setProgress( qreal );
+
+        //* animation
+        const Animation::Pointer& animation() const
+        { return _animation; }
+
+        //@}
+
         //*@name current index handling
         //@{
 
@@ -59,14 +75,6 @@ namespace Feren
         qreal currentOpacity() const
         { return _current._opacity; }
 
-        //* current opacity
-        void setCurrentOpacity( qreal value )
-        {
-            if( _current._opacity == value ) return;
-            _current._opacity = value;
-            setDirty();
-        }
-
         //* current index
         int currentIndex() const
         { return _current._index; }
@@ -75,10 +83,6 @@ namespace Feren
         void setCurrentIndex( int index )
         { _current._index = index; }
 
-        //* current index animation
-        const Animation::Pointer& currentIndexAnimation() const
-        { return _current._animation; }
-
         //@}
 
         //*@name previous index handling
@@ -88,14 +92,6 @@ namespace Feren
         qreal previousOpacity() const
         { return _previous._opacity; }
 
-        //* previous opacity
-        void setPreviousOpacity( qreal value )
-        {
-            if( _previous._opacity == value ) return;
-            _previous._opacity = value;
-            setDirty();
-        }
-
         //* previous index
         int previousIndex() const
         { return _previous._index; }
@@ -104,10 +100,6 @@ namespace Feren
         void setPreviousIndex( int index )
         { _previous._index = index; }
 
-        //* previous index Animation
-        const Animation::Pointer& previousIndexAnimation() const
-        { return _previous._animation; }
-
         //@}
 
         //* return Animation associated to action at given position, if any
@@ -118,6 +110,12 @@ namespace Feren
 
         private:
 
+        //* move current tab to previous, and start animation
+        void startAnimation( int index );
+
+        //* region covering current and previous tabs
+        QRegion tabRegion() const;
+
         //* container for needed animation data
         class Data
         {
@@ -129,11 +127,19 @@ namespace Feren
                 _index(-1)
             {}
 
-            Animation::Pointer _animation;
             qreal _opacity;
             int _index;
         };
 
+        //* animation
+        Animation::Pointer _animation;
+
+        //* progress
+        qreal _progress = 0;
+
+        //* previous tab opacity when animation started
+        qreal _previousStartOpacity = 0;
+
         //* current tab animation data (for hover enter animations)
         Data _current;
 
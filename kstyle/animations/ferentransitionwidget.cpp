@@ -26,10 +26,132 @@
 
 #include "ferentransitionwidget.h"
 
+#include "ferentracerecorder.h"
+
+#include <QBackingStore>
 #include <QPainter>
 #include <QPaintEvent>
 #include <QStyleOption>
 #include <QTextStream>
+#include <QVarLengthArray>
+#include <QWindow>
+
+#include <algorithm>
+
+#if defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
+
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#include <immintrin.h>
+#define FEREN_BLEND_AVX2 1
+#endif
+
+namespace
+{
+
+    //* cross-fade one scanline of premultiplied pixels, with weight in [0,256] applied to end pixels
+    /** red/blue and alpha/green channel pairs are processed in parallel */
+    void blendScanLine( const quint32* start, const quint32* end, quint32* target, int count, uint weight )
+    {
+        const uint inverse( 256 - weight );
+        for( int i = 0; i < count; ++i )
+        {
+            const quint32 source( start[i] );
+            const quint32 destination( end[i] );
+            const quint32 rb( ( ( source&0xff00ff )*inverse + ( destination&0xff00ff )*weight ) >> 8 );
+            const quint32 ag( ( ( source >> 8 )&0xff00ff )*inverse + ( ( destination >> 8 )&0xff00ff )*weight );
+            target[i] = ( rb&0xff00ff ) | ( ag&0xff00ff00 );
+        }
+    }
+
+    #if defined( __SSE2__ )
+    //* cross-fade one scanline, four pixels at a time
+    void blendScanLineSSE2( const quint32* start, const quint32* end, quint32* target, int count, uint weight )
+    {
+        const __m128i zero( _mm_setzero_si128() );
+        const __m128i endWeight( _mm_set1_epi16( weight ) );
+        const __m128i startWeight( _mm_set1_epi16( 256 - weight ) );
+
+        int i = 0;
+        for( ; i + 4 <= count; i += 4 )
+        {
+            const __m128i source( _mm_loadu_si128( reinterpret_cast<const __m128i*>( start + i ) ) );
+            const __m128i destination( _mm_loadu_si128( reinterpret_cast<const __m128i*>( end + i ) ) );
+
+            const __m128i low( _mm_srli_epi16( _mm_add_epi16(
+                _mm_mullo_epi16( _mm_unpacklo_epi8( source, zero ), startWeight ),
+                _mm_mullo_epi16( _mm_unpacklo_epi8( destination, zero ), endWeight ) ), 8 ) );
+
+            const __m128i high( _mm_srli_epi16( _mm_add_epi16(
+                _mm_mullo_epi16( _mm_unpackhi_epi8( source, zero ), startWeight ),
+                _mm_mullo_epi16( _mm_unpackhi_epi8( destination, zero ), endWeight ) ), 8 ) );
+
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( target + i ), _mm_packus_epi16( low, high ) );
+        }
+
+        blendScanLine( start + i, end + i, target + i, count - i, weight );
+    }
+    #endif
+
+    #if defined( FEREN_BLEND_AVX2 )
+    //* cross-fade one scanline, eight pixels at a time
+    __attribute__(( target( "avx2" ) ))
+    void blendScanLineAVX2( const quint32* start, const quint32* end, quint32* target, int count, uint weight )
+    {
+        const __m256i zero( _mm256_setzero_si256() );
+        const __m256i endWeight( _mm256_set1_epi16( weight ) );
+        const __m256i startWeight( _mm256_set1_epi16( 256 - weight ) );
+
+        int i = 0;
+        for( ; i + 8 <= count; i += 8 )
+        {
+            const __m256i source( _mm256_loadu_si256( reinterpret_cast<const __m256i*>( start + i ) ) );
+            const __m256i destination( _mm256_loadu_si256( reinterpret_cast<const __m256i*>( end + i ) ) );
+
+            // unpack and pack both operate within 128 bits lanes, so that pixel order is preserved
+            const __m256i low( _mm256_srli_epi16( _mm256_add_epi16(
+                _mm256_mullo_epi16( _mm256_unpacklo_epi8( source, zero ), startWeight ),
+                _mm256_mullo_epi16( _mm256_unpacklo_epi8( destination, zero ), endWeight ) ), 8 ) );
+
+            const __m256i high( _mm256_srli_epi16( _mm256_add_epi16(
+                _mm256_mullo_epi16( _mm256_unpackhi_epi8( source, zero ), startWeight ),
+                _mm256_mullo_epi16( _mm256_unpackhi_epi8( destination, zero ), endWeight ) ), 8 ) );
+
+            _mm256_storeu_si256( reinterpret_cast<__m256i*>( target + i ), _mm256_packus_epi16( low, high ) );
+        }
+
+        blendScanLine( start + i, end + i, target + i, count - i, weight );
+    }
+    #endif
+
+    //* scanline blending function
+    using BlendFunction = void (*)( const quint32*, const quint32*, quint32*, int, uint );
+
+    //* select best scanline blending function for the running cpu
+    BlendFunction blendFunction()
+    {
+        #if defined( FEREN_BLEND_AVX2 )
+        if( __builtin_cpu_supports( "avx2" ) ) return blendScanLineAVX2;
+        #endif
+
+        #if defined( __SSE2__ )
+        return blendScanLineSSE2;
+        #else
+        return blendScanLine;
+        #endif
+    }
+
+    //* convert pixmap to a format suitable for blending
+    QImage blendImage( const QPixmap& pixmap )
+    {
+        QImage image( pixmap.toImage() );
+        if( image.format() != QImage::Format_ARGB32_Premultiplied )
+        { image = image.convertToFormat( QImage::Format_ARGB32_Premultiplied ); }
+        return image;
+    }
+
+}
 
 namespace Feren
 {
@@ -40,6 +162,7 @@ namespace Feren
     { return _paintEnabled; }
 
     int TransitionWidget::_steps = 0;
+    ImagePool* TransitionWidget::_imagePool = nullptr;
 
     //________________________________________________
     TransitionWidget::TransitionWidget( QWidget* parent, int duration ):
@@ -66,15 +189,20 @@ namespace Feren
     QPixmap TransitionWidget::grab( QWidget* widget, QRect rect )
     {
 
+        const TraceRecorder::Span traceSpan( "transition", "TransitionWidget::grab", widget->metaObject()->className() );
+
         // change rect
         if( !rect.isValid() ) rect = widget->rect();
         if( !rect.isValid() ) return QPixmap();
 
-        // initialize pixmap
-        QPixmap out( rect.size() );
-        out.fill( Qt::transparent );
+        // start clock
+        _grabClock.start();
+        _grabbedFromBackingStore = false;
+        _firstFrameTime = -1;
+
         _paintEnabled = false;
 
+        QPixmap out;
         if( testFlag( GrabFromWindow ) )
         {
 
@@ -84,17 +212,67 @@ namespace Feren
 
         } else {
 
-            if( !testFlag( Transparent ) ) { grabBackground( out, widget, rect ); }
-            grabWidget( out, widget, rect );
+            // initialize pixmap
+            // when grabbing at reduced resolution, the pixmap device pixel ratio takes care of scaling down all rendering
+            const bool scaled( _grabScale < 1.0 );
+            const QSize size( scaled ? ( QSizeF( rect.size() )*_grabScale ).toSize().expandedTo( QSize( 1, 1 ) ) : rect.size() );
+            out = _imagePool ? _imagePool->pixmap( size ) : QPixmap( size );
+            if( scaled ) out.setDevicePixelRatio( _grabScale );
+            out.fill( Qt::transparent );
+
+            if( !testFlag( Transparent ) && grabBackingStore( out, widget, rect ) )
+            {
+
+                _grabbedFromBackingStore = true;
+
+            } else {
+
+                if( !testFlag( Transparent ) ) { grabBackground( out, widget, rect ); }
+                grabWidget( out, widget, rect );
+
+            }
 
         }
 
         _paintEnabled = true;
+        _grabTime = _grabClock.elapsed();
 
         return out;
 
     }
 
+    //________________________________________________
+    void TransitionWidget::setStartPixmap( QPixmap pixmap )
+    {
+        releaseBuffers( _startPixmap, _startImage );
+        _startPixmap = pixmap;
+    }
+
+    //________________________________________________
+    void TransitionWidget::setEndPixmap( QPixmap pixmap )
+    {
+        releaseBuffers( _endPixmap, _endImage );
+        _endPixmap = pixmap;
+    }
+
+    //________________________________________________
+    void TransitionWidget::releaseBuffers( QPixmap& pixmap, QImage& image )
+    {
+
+        // converted image may share data with the pixmap, it must go first
+        image = QImage();
+
+        if( _imagePool )
+        {
+            _imagePool->release( pixmap );
+            _imagePool->release( _blendBuffer );
+        }
+
+        pixmap = QPixmap();
+        _blendBuffer = QImage();
+
+    }
+
     //________________________________________________
     bool TransitionWidget::event( QEvent* event )
     {
@@ -126,77 +304,55 @@ namespace Feren
         QRect rect = event->rect();
         if( !rect.isValid() ) rect = this->rect();
 
-        // local pixmap
-        const bool paintOnWidget( testFlag( PaintOnWidget ) && !testFlag( Transparent ) );
-        if( !paintOnWidget )
-        {
+        // time to first frame
+        if( _firstFrameTime < 0 && _grabClock.isValid() )
+        { _firstFrameTime = _grabClock.elapsed(); }
 
-            if( _currentPixmap.isNull() || _currentPixmap.size() != size() )
-            { _currentPixmap = QPixmap( size() ); }
+        // pixmaps grabbed at reduced resolution are upscaled
+        QPainter painter( this );
+        painter.setClipRect( event->rect() );
+        painter.setRenderHint( QPainter::SmoothPixmapTransform );
 
+        // end pixmap only. Unless the target is transparent, it is rendered as is, below the fading start pixmap
+        if( opacity() > 0.996 || ( _startPixmap.isNull() && !testFlag( Transparent ) ) )
+        {
+            if( !_endPixmap.isNull() ) painter.drawPixmap( QPoint(), _endPixmap );
+            return;
         }
 
-        // fill
-        _currentPixmap.fill( Qt::transparent );
-
-        // copy local pixmap to current
+        // start pixmap only
+        if( opacity() < 0.004 )
         {
+            if( !_startPixmap.isNull() ) painter.drawPixmap( QPoint(), _startPixmap );
+            return;
+        }
 
-            QPainter p;
-
-            // draw end pixmap first, provided that opacity is small enough
-            if( opacity() >= 0.004 && !_endPixmap.isNull() )
-            {
-
-                // faded endPixmap if parent target is transparent and opacity is
-                if( opacity() <= 0.996 && testFlag( Transparent ) )
-                {
-
-                    fade( _endPixmap, _currentPixmap, opacity(), rect );
-                    p.begin( &_currentPixmap );
-                    p.setClipRect( event->rect() );
-
-                } else {
-
-                    if( paintOnWidget ) p.begin( this );
-                    else p.begin( &_currentPixmap );
-                    p.setClipRect( event->rect() );
-                    p.drawPixmap( QPoint(), _endPixmap );
-
-                }
+        // cross-fade
+        const QRect blendRect( blend( opacity(), rect ) );
+        if( blendRect.isValid() )
+        {
 
-            } else {
+            const qreal devicePixelRatio( _blendBuffer.devicePixelRatio() );
+            const QRectF target( QPointF( blendRect.topLeft() )/devicePixelRatio, QSizeF( blendRect.size() )/devicePixelRatio );
+            painter.drawImage( target, _blendBuffer, QRectF( blendRect ) );
 
-                if( paintOnWidget ) p.begin( this );
-                else p.begin( &_currentPixmap );
-                p.setClipRect( event->rect() );
+        } else {
 
+            // pixmaps with mismatching geometry are faded separately
+            if( !_endPixmap.isNull() )
+            {
+                painter.setOpacity( testFlag( Transparent ) ? opacity() : 1.0 );
+                painter.drawPixmap( QPoint(), _endPixmap );
             }
 
-            // draw fading start pixmap
-            if( opacity() <= 0.996 && !_startPixmap.isNull() )
+            if( !_startPixmap.isNull() )
             {
-                if( opacity() >= 0.004 )
-                {
-
-                    fade( _startPixmap, _localStartPixmap, 1.0-opacity(), rect );
-                    p.drawPixmap( QPoint(), _localStartPixmap );
-
-                } else p.drawPixmap( QPoint(), _startPixmap );
-
+                painter.setOpacity( 1.0 - opacity() );
+                painter.drawPixmap( QPoint(), _startPixmap );
             }
 
-            p.end();
         }
 
-        // copy current pixmap on widget
-        if( !paintOnWidget )
-        {
-            QPainter p( this );
-            p.setClipRect( event->rect() );
-            p.drawPixmap( QPoint(0,0), _currentPixmap );
-            p.end();
-        }
     }
 
     //________________________________________________
@@ -237,7 +393,8 @@ namespace Feren
 
         } else {
 
-            p.fillRect( pixmap.rect(), backgroundBrush );
+            // painter works in logical coordinates, which differ from the pixmap's when grabbing at reduced scale
+            p.fillRect( QRect( QPoint(), rect.size() ), backgroundBrush );
 
         }
 
@@ -271,34 +428,142 @@ namespace Feren
     { widget->render( &pixmap, pixmap.rect().topLeft(), rect, QWidget::DrawChildren ); }
 
     //________________________________________________
-    void TransitionWidget::fade( const QPixmap& source, QPixmap& target, qreal opacity, const QRect& rect ) const
+    bool TransitionWidget::grabBackingStore( QPixmap& pixmap, QWidget* widget, const QRect& rect ) const
     {
 
-        if( target.isNull() || target.size() != size() )
-        { target = QPixmap( size() ); }
+        // the backing store would contain the previous transition, if still visible
+        if( isVisible() || !widget ) return false;
+
+        /*
+        widget itself might already be hidden, as is the case for stacked widget pages when current index changes.
+        Its content is still in the backing store, as long as the window has not been repainted since
+        */
+        QWidget* window( widget->window() );
+        if( !( window->isVisible() && window->updatesEnabled() ) ) return false;
+
+        // widgets composited at flush time leave holes in the backing store
+        if( hasCompositedContent( widget, rect ) ) return false;
+
+        // window must be exposed for its backing store to be up to date
+        QWindow* windowHandle( window->windowHandle() );
+        if( !( windowHandle && windowHandle->isExposed() ) ) return false;
+
+        // only raster backing stores can be read back
+        QBackingStore* backingStore( window->backingStore() );
+        QPaintDevice* device( backingStore ? backingStore->paintDevice() : nullptr );
+        if( !( device && device->devType() == QInternal::Image ) ) return false;
+
+        const QImage& image( *static_cast<QImage*>( device ) );
+        if( image.isNull() ) return false;
+
+        // map rect to backing store
+        const qreal devicePixelRatio( image.devicePixelRatio() );
+        const QRect windowRect( widget->mapTo( window, rect.topLeft() ), rect.size() );
+        const QRect source( QRectF(
+            QPointF( windowRect.topLeft() )*devicePixelRatio,
+            QSizeF( windowRect.size() )*devicePixelRatio ).toAlignedRect() );
+        if( !image.rect().contains( source ) ) return false;
+
+        // copy, taking grab scale into account
+        QPainter painter( &pixmap );
+        painter.setRenderHint( QPainter::SmoothPixmapTransform );
+        painter.setCompositionMode( QPainter::CompositionMode_Source );
+        painter.drawImage( QRectF( QPointF( 0, 0 ), QSizeF( rect.size() ) ), image, QRectF( source ) );
+        return true;
 
-        // erase target
-        target.fill( Qt::transparent );
+    }
 
-        // check opacity
-        if( opacity*255 < 1 ) return;
+    //________________________________________________
+    bool TransitionWidget::hasCompositedContent( QWidget* widget, const QRect& rect )
+    {
 
-        QPainter p( &target );
-        p.setClipRect( rect );
+        // native child widgets paint to their own surface. Windows themselves own the backing store
+        auto isComposited = []( const QWidget* widget )
+        {
+            return ( !widget->isWindow() && widget->testAttribute( Qt::WA_NativeWindow ) ) ||
+                widget->testAttribute( Qt::WA_PaintOnScreen ) ||
+                widget->inherits( "QOpenGLWidget" ) ||
+                widget->inherits( "QQuickWidget" );
+        };
 
-        // draw pixmap
-        p.drawPixmap( QPoint(0,0), source );
+        if( isComposited( widget ) ) return true;
 
-        // opacity mask (0.996 corresponds to 254/255)
-        if( opacity <= 0.996 )
+        for( const QWidget* child : widget->findChildren<QWidget*>() )
         {
-            p.setCompositionMode(QPainter::CompositionMode_DestinationIn);
-            QColor color( Qt::black );
-            color.setAlphaF( opacity );
-            p.fillRect(rect, color );
+            if( child->isWindow() ) continue;
+            if( !( child->isVisibleTo( widget ) && isComposited( child ) ) ) continue;
+
+            const QRect childRect( child->mapTo( widget, QPoint() ), child->size() );
+            if( childRect.intersects( rect ) ) return true;
         }
 
-        p.end();
-   }
+        return false;
+
+    }
+
+    //________________________________________________
+    QRect TransitionWidget::blend( qreal opacity, const QRect& rect )
+    {
+
+        // convert pixmaps once per transition
+        if( _startImage.isNull() && !_startPixmap.isNull() ) _startImage = blendImage( _startPixmap );
+        if( _endImage.isNull() && !_endPixmap.isNull() ) _endImage = blendImage( _endPixmap );
+
+        // reference image, used for geometry
+        const QImage& reference( _startImage.isNull() ? _endImage : _startImage );
+        if( reference.isNull() ) return QRect();
+        if( !( _startImage.isNull() || _endImage.isNull() ) )
+        {
+            if( _startImage.size() != _endImage.size() ) return QRect();
+            if( _startImage.devicePixelRatio() != _endImage.devicePixelRatio() ) return QRect();
+        }
+
+        // reuse buffer as long as geometry is unchanged
+        if( _blendBuffer.size() != reference.size() )
+        {
+            if( _imagePool ) _imagePool->release( _blendBuffer );
+            _blendBuffer = _imagePool ?
+                _imagePool->image( reference.size() ):
+                QImage( reference.size(), QImage::Format_ARGB32_Premultiplied );
+        }
+        _blendBuffer.setDevicePixelRatio( reference.devicePixelRatio() );
+
+        // map rect to device pixels
+        const qreal devicePixelRatio( reference.devicePixelRatio() );
+        const QRect deviceRect( QRectF(
+            QPointF( rect.topLeft() )*devicePixelRatio,
+            QSizeF( rect.size() )*devicePixelRatio ).toAlignedRect() & reference.rect() );
+        if( deviceRect.isEmpty() ) return QRect();
+
+        // missing pixmaps are blended as fully transparent
+        const int width( deviceRect.width() );
+        QVarLengthArray<quint32, 1024> transparent;
+        if( _startImage.isNull() || _endImage.isNull() )
+        {
+            transparent.resize( width );
+            std::fill( transparent.begin(), transparent.end(), 0 );
+        }
+
+        static const BlendFunction blendLine( blendFunction() );
+        const uint weight( qRound( opacity*256 ) );
+        for( int y = deviceRect.top(); y <= deviceRect.bottom(); ++y )
+        {
+
+            const quint32* start( _startImage.isNull() ?
+                transparent.constData():
+                reinterpret_cast<const quint32*>( _startImage.constScanLine( y ) ) + deviceRect.left() );
+
+            const quint32* end( _endImage.isNull() ?
+                transparent.constData():
+                reinterpret_cast<const quint32*>( _endImage.constScanLine( y ) ) + deviceRect.left() );
+
+            quint32* target( reinterpret_cast<quint32*>( _blendBuffer.scanLine( y ) ) + deviceRect.left() );
+            blendLine( start, end, target, width, weight );
+
+        }
+
+        return deviceRect;
+
+    }
 
 }
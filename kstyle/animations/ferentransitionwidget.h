@@ -28,7 +28,10 @@
 
 #include "ferenanimation.h"
 #include "feren.h"
+#include "ferenimagepool.h"
 
+#include <QElapsedTimer>
+#include <QImage>
 #include <QWidget>
 
 #include <cmath>
@@ -94,6 +97,10 @@ namespace Feren
         static void setSteps( int value )
         { _steps = value; }
 
+        //* pool used for grabbed pixmaps and blending buffers
+        static void setImagePool( ImagePool* value )
+        { _imagePool = value; }
+
         //*@name opacity
         //@{
 
@@ -118,8 +125,7 @@ namespace Feren
         { setStartPixmap( QPixmap() ); }
 
         //* start
-        void setStartPixmap( QPixmap pixmap )
-        { _startPixmap = pixmap; }
+        void setStartPixmap( QPixmap );
 
         //* start
         const QPixmap& startPixmap() const
@@ -130,25 +136,48 @@ namespace Feren
         { setEndPixmap( QPixmap() ); }
 
         //* end
-        void setEndPixmap( QPixmap pixmap )
-        {
-            _endPixmap = pixmap;
-            _currentPixmap = pixmap;
-        }
+        void setEndPixmap( QPixmap );
 
         //* start
         const QPixmap& endPixmap() const
         { return _endPixmap; }
 
-        //* current
-        const QPixmap& currentPixmap() const
-        { return _currentPixmap; }
+        //@}
+
+        //*@name grab scale
+        //@{
+
+        //* scale at which widgets are grabbed
+        /** when smaller than one, pixmaps are grabbed at reduced resolution, and upscaled when painted */
+        void setGrabScale( qreal value )
+        { _grabScale = qBound<qreal>( 0.01, value, 1.0 ); }
+
+        //* scale at which widgets are grabbed
+        qreal grabScale() const
+        { return _grabScale; }
 
         //@}
 
         //* grap pixmap
         QPixmap grab( QWidget* = nullptr, QRect = QRect() );
 
+        //*@name grab statistics
+        //@{
+
+        //* true if last grab was copied from the window backing store
+        bool grabbedFromBackingStore() const
+        { return _grabbedFromBackingStore; }
+
+        //* time spent in last grab (msec)
+        qint64 grabTime() const
+        { return _grabTime; }
+
+        //* time between last grab and first transition frame (msec), or -1 if not painted yet
+        qint64 firstFrameTime() const
+        { return _firstFrameTime; }
+
+        //@}
+
         //* true if animated
         bool isAnimated() const
         { return _animation.data()->isRunning(); }
@@ -186,8 +215,19 @@ namespace Feren
         //* grab widget
         void grabWidget( QPixmap&, QWidget*, QRect& ) const;
 
-        //* fade pixmap
-        void fade( const QPixmap& source, QPixmap& target, qreal opacity, const QRect& ) const;
+        //* grab widget and background from the window backing store, when up to date
+        /** returns false if the backing store cannot be used, in which case pixmap is left unchanged */
+        bool grabBackingStore( QPixmap&, QWidget*, const QRect& ) const;
+
+        //* true if rect of widget shows native, OpenGL or QtQuick content, which is not in the raster backing store
+        static bool hasCompositedContent( QWidget*, const QRect& );
+
+        //* cross-fade start and end pixmaps into blend buffer
+        /** returns the blended area, in device pixels, or an invalid rect if pixmaps cannot be blended */
+        QRect blend( qreal opacity, const QRect& );
+
+        //* give pixmap, image and blending buffer back to the pool
+        void releaseBuffers( QPixmap&, QImage& );
 
         //* apply step
         qreal digitize( const qreal& value ) const
@@ -210,21 +250,42 @@ namespace Feren
         //* animation starting pixmap
         QPixmap _startPixmap;
 
-        //* animation starting pixmap
-        QPixmap _localStartPixmap;
-
-        //* animation starting pixmap
+        //* animation ending pixmap
         QPixmap _endPixmap;
 
-        //* current pixmap
-        QPixmap _currentPixmap;
+        //* starting pixmap, converted for blending
+        QImage _startImage;
+
+        //* ending pixmap, converted for blending
+        QImage _endImage;
+
+        //* blended image, reused from one frame to the next
+        QImage _blendBuffer;
 
         //* current state opacity
         qreal _opacity = 0;
 
+        //* grab scale
+        qreal _grabScale = 1.0;
+
+        //* timer started on grab, used to measure time to first frame
+        QElapsedTimer _grabClock;
+
+        //* true if last grab was copied from the window backing store
+        bool _grabbedFromBackingStore = false;
+
+        //* time spent in last grab
+        qint64 _grabTime = 0;
+
+        //* time between last grab and first transition frame
+        qint64 _firstFrameTime = -1;
+
         //* steps
         static int _steps;
 
+        //* image pool
+        static ImagePool* _imagePool;
+
     };
 
 }
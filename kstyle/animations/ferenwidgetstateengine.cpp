@@ -26,14 +26,14 @@ namespace Feren
 {
 
     //____________________________________________________________
-    bool WidgetStateEngine::registerWidget( QWidget* widget, AnimationModes mode )
+    bool WidgetStateEngine::registerWidget( QWidget* widget, AnimationModes mode, AnimationData::DirtyArea dirtyArea )
     {
 
         if( !widget ) return false;
-        if( mode&AnimationHover && !_hoverData.contains( widget ) ) { _hoverData.insert( widget, new WidgetStateData( this, widget, duration() ), enabled() ); }
-        if( mode&AnimationFocus && !_focusData.contains( widget ) ) { _focusData.insert( widget, new WidgetStateData( this, widget, duration() ), enabled() ); }
+        if( mode&AnimationHover && !_hoverData.contains( widget ) ) { _hoverData.insert( widget, createData( widget, dirtyArea ), enabled() ); }
+        if( mode&AnimationFocus && !_focusData.contains( widget ) ) { _focusData.insert( widget, createData( widget, dirtyArea ), enabled() ); }
         if( mode&AnimationEnable && !_enableData.contains( widget ) ) { _enableData.insert( widget, new EnableData( this, widget, duration() ), enabled() ); }
-        if( mode&AnimationPressed && !_pressedData.contains( widget ) ) { _pressedData.insert( widget, new WidgetStateData( this, widget, duration() ), enabled() ); }
+        if( mode&AnimationPressed && !_pressedData.contains( widget ) ) { _pressedData.insert( widget, createData( widget, dirtyArea ), enabled() ); }
 
         // connect destruction signal
         connect( widget, SIGNAL(destroyed(QObject*)), this, SLOT(unregisterWidget(QObject*)), Qt::UniqueConnection );
@@ -125,4 +125,12 @@ namespace Feren
 
     }
 
+    //____________________________________________________________
+    WidgetStateData* WidgetStateEngine::createData( QWidget* widget, AnimationData::DirtyArea dirtyArea )
+    {
+        WidgetStateData* data( new WidgetStateData( this, widget, duration() ) );
+        data->setDirtyArea( dirtyArea );
+        return data;
+    }
+
 }
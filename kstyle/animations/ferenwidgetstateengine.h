@@ -42,7 +42,8 @@ namespace Feren
         {}
 
         //* register widget
-        bool registerWidget( QWidget*, AnimationModes );
+        /** dirty area controls the region repainted on hover, focus and pressed animation steps */
+        bool registerWidget( QWidget*, AnimationModes, AnimationData::DirtyArea = AnimationData::DirtyWidget );
 
         //* returns registered widgets
         WidgetList registeredWidgets( AnimationModes ) const;
@@ -143,6 +144,9 @@ namespace Feren
 
         private:
 
+        //* create data for hover, focus and pressed animations
+        WidgetStateData* createData( QWidget*, AnimationData::DirtyArea );
+
         //* maps
         DataMap<WidgetStateData> _hoverData;
         DataMap<WidgetStateData> _focusData;
@@ -0,0 +1,92 @@
+/*************************************************************************
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include "ferenhelper.h"
+
+#include <QImage>
+#include <QPainter>
+#include <QStandardPaths>
+#include <QTest>
+
+//* check that cached glyphs and branch lines are shared across color fades
+class FerenGlyphCacheTest: public QObject
+{
+
+    Q_OBJECT
+
+    private Q_SLOTS:
+
+    //* use test configuration
+    void initTestCase()
+    { QStandardPaths::setTestModeEnabled( true ); }
+
+    //* arrows fading in and out use a single glyph
+    void arrowFade()
+    {
+        Feren::Helper helper( KSharedConfig::openConfig() );
+
+        QImage image( 32, 32, QImage::Format_ARGB32_Premultiplied );
+        image.fill( Qt::transparent );
+
+        QPainter painter( &image );
+        for( int alpha = 0; alpha <= 255; alpha += 15 )
+        {
+            QColor color( Qt::black );
+            color.setAlpha( alpha );
+            helper.renderArrow( &painter, QRect( 8, 8, 16, 16 ), color, Feren::ArrowDown );
+        }
+        painter.end();
+
+        QCOMPARE( misses( helper, QStringLiteral( "ArrowAtlas" ) ), qint64( 1 ) );
+    }
+
+    //* tree branch lines fading in and out use a single pixmap
+    void treeBranchFade()
+    {
+        Feren::Helper helper( KSharedConfig::openConfig() );
+
+        QImage image( 32, 32, QImage::Format_ARGB32_Premultiplied );
+        image.fill( Qt::transparent );
+
+        QPainter painter( &image );
+        for( int alpha = 0; alpha <= 255; alpha += 15 )
+        {
+            QColor color( Qt::black );
+            color.setAlpha( alpha );
+            helper.renderTreeBranch( &painter, QRect( 0, 0, 20, 20 ), color, Feren::TreeBranchTop|Feren::TreeBranchSide, 4, false );
+        }
+        painter.end();
+
+        QCOMPARE( misses( helper, QStringLiteral( "TreeBranches" ) ), qint64( 1 ) );
+    }
+
+    private:
+
+    //* cache misses for a given cache
+    static qint64 misses( const Feren::Helper& helper, const QString& name )
+    {
+        for( const auto& statistics : helper.cacheRegistry().statistics() )
+        { if( statistics.name == name ) return statistics.misses; }
+
+        return -1;
+    }
+
+};
+
+QTEST_MAIN( FerenGlyphCacheTest )
+
+#include "ferenglyphcachetest.moc"
@@ -0,0 +1,64 @@
+/*************************************************************************
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include "ferenimagepool.h"
+
+#include <QPixmap>
+#include <QTest>
+
+//* check that pooled buffers are reused by pixmaps
+class FerenImagePoolTest: public QObject
+{
+
+    Q_OBJECT
+
+    private Q_SLOTS:
+
+    //* pixmaps adopt pooled buffers, even when their content is opaque
+    void pixmapAdoptsBuffer()
+    {
+        Feren::ImagePool pool;
+
+        // opaque content, that would be converted to another format with opaque detection
+        QPixmap first( pool.pixmap( QSize( 100, 100 ) ) );
+        first.fill( Qt::red );
+        pool.release( first );
+        QCOMPARE( pool.allocationCount(), qint64( 1 ) );
+        QVERIFY( pool.cost() > 0 );
+
+        // same size class. Buffer content is left untouched by the pool
+        QPixmap second( pool.pixmap( QSize( 90, 90 ) ) );
+        QCOMPARE( pool.reuseCount(), qint64( 1 ) );
+        QCOMPARE( pool.allocationCount(), qint64( 1 ) );
+        QCOMPARE( pool.cost(), qint64( 0 ) );
+        QVERIFY( second.hasAlphaChannel() );
+
+        // the pixmap renders into the pooled buffer, which gets back to the pool once released
+        second.fill( Qt::transparent );
+        pool.release( second );
+        QVERIFY( pool.cost() > 0 );
+
+        const QImage third( pool.image( QSize( 100, 100 ) ) );
+        QCOMPARE( pool.reuseCount(), qint64( 2 ) );
+        QCOMPARE( third.pixel( 0, 0 ), QColor( Qt::transparent ).rgba() );
+    }
+
+};
+
+QTEST_MAIN( FerenImagePoolTest )
+
+#include "ferenimagepooltest.moc"
@@ -0,0 +1,127 @@
+/*************************************************************************
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include "ferenstyle.h"
+
+#include <QApplication>
+#include <QItemSelectionModel>
+#include <QPixmap>
+#include <QScreen>
+#include <QScrollBar>
+#include <QStandardItemModel>
+#include <QTableView>
+#include <QTest>
+
+//* scroll a large table, with alternate rows and full row selection
+class FerenItemViewBenchmark: public QObject
+{
+
+    Q_OBJECT
+
+    private Q_SLOTS:
+
+    //* use style for all widgets
+    void initTestCase()
+    { QApplication::setStyle( new Feren::Style ); }
+
+    //* create table
+    void init()
+    {
+        _model = new QStandardItemModel( Rows, Columns, this );
+        _view = new QTableView;
+        _view->setModel( _model );
+        _view->setAlternatingRowColors( true );
+        _view->setSelectionBehavior( QAbstractItemView::SelectRows );
+        _view->resize( 1200, 800 );
+
+        // select one row out of three, so that selected rows also get alternate colors
+        for( int row = 0; row < Rows; row += 3 )
+        { _view->selectionModel()->select( _model->index( row, 0 ), QItemSelectionModel::Select|QItemSelectionModel::Rows ); }
+
+        _view->show();
+        QVERIFY( QTest::qWaitForWindowExposed( _view ) );
+    }
+
+    //* delete table
+    void cleanup()
+    {
+        delete _view;
+        delete _model;
+    }
+
+    //* scroll benchmark
+    void scroll_data()
+    {
+        QTest::addColumn<bool>( "batched" );
+        QTest::newRow( "per cell" ) << false;
+        QTest::newRow( "row spans" ) << true;
+    }
+
+    void scroll()
+    {
+        QFETCH( bool, batched );
+
+        // cells rendered to a pixmap are not batched, which gives the per cell baseline
+        QPixmap pixmap( _view->viewport()->size() );
+        QScrollBar* scrollBar( _view->verticalScrollBar() );
+
+        QBENCHMARK
+        {
+            for( int value = scrollBar->minimum(); value <= scrollBar->maximum(); value += scrollBar->pageStep() )
+            {
+                scrollBar->setValue( value );
+                if( batched ) _view->viewport()->repaint();
+                else _view->viewport()->render( &pixmap );
+            }
+        }
+    }
+
+    //* selected cells beyond the first column keep their highlight in alternate rows
+    void selectedAlternateRow()
+    {
+        _view->viewport()->repaint();
+        const QImage batched( QGuiApplication::primaryScreen()->grabWindow( _view->winId() ).toImage() );
+
+        QPixmap pixmap( _view->viewport()->size() );
+        _view->viewport()->render( &pixmap );
+        const QImage perCell( pixmap.toImage() );
+
+        // row 3 is both selected and alternate
+        const QPoint offset( _view->viewport()->mapTo( _view, QPoint() ) );
+        for( int column = 0; column < Columns; column += 5 )
+        {
+            const QPoint center( _view->visualRect( _model->index( 3, column ) ).center() );
+            QCOMPARE( batched.pixel( center + offset ), perCell.pixel( center ) );
+        }
+    }
+
+    private:
+
+    enum
+    {
+        Rows = 200,
+        Columns = 20
+    };
+
+    QStandardItemModel* _model = nullptr;
+    QTableView* _view = nullptr;
+
+};
+
+QTEST_MAIN( FerenItemViewBenchmark )
+
+#include "ferenitemviewbenchmark.moc"
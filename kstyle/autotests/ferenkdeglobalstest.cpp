@@ -0,0 +1,122 @@
+/*************************************************************************
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include "ferenstyle.h"
+
+#include <KConfig>
+#include <KConfigGroup>
+#include <KSharedConfig>
+
+#include <QApplication>
+#include <QPixmap>
+#include <QStandardPaths>
+#include <QStyleOptionButton>
+#include <QTest>
+
+//* check that kdeglobals changes are picked up while the application runs
+class FerenKdeGlobalsTest: public QObject
+{
+
+    Q_OBJECT
+
+    private Q_SLOTS:
+
+    //* use test configuration
+    void initTestCase()
+    { QStandardPaths::setTestModeEnabled( true ); }
+
+    //* ShowIconsOnPushButtons
+    void showIconsOnPushButtons()
+    {
+        writeSetting( QStringLiteral( "ShowIconsOnPushButtons" ), true );
+
+        Feren::Style style;
+        const int widthWithIcon( buttonWidth( style ) );
+
+        // change kdeglobals behind the style's back, then notify as KGlobalSettings would
+        writeSetting( QStringLiteral( "ShowIconsOnPushButtons" ), false );
+        notifyChange( style );
+        QVERIFY( buttonWidth( style ) < widthWithIcon );
+
+        writeSetting( QStringLiteral( "ShowIconsOnPushButtons" ), true );
+        notifyChange( style );
+        QCOMPARE( buttonWidth( style ), widthWithIcon );
+    }
+
+    //* per application overrides of kdeglobals settings
+    void applicationOverride()
+    {
+        writeSetting( QStringLiteral( "ShowIconsOnPushButtons" ), true );
+
+        Feren::Style style;
+        const int widthWithIcon( buttonWidth( style ) );
+
+        // the application's own configuration cascades over kdeglobals
+        const QString applicationConfig( KSharedConfig::openConfig()->name() );
+        writeSetting( QStringLiteral( "ShowIconsOnPushButtons" ), false, applicationConfig );
+        notifyChange( style );
+        QVERIFY( buttonWidth( style ) < widthWithIcon );
+
+        removeSetting( QStringLiteral( "ShowIconsOnPushButtons" ), applicationConfig );
+        notifyChange( style );
+        QCOMPARE( buttonWidth( style ), widthWithIcon );
+    }
+
+    private:
+
+    //* write kdeglobals entry, or the entry of another configuration file, as an external process would
+    void writeSetting( const QString& key, bool value, const QString& fileName = QStringLiteral( "kdeglobals" ) )
+    {
+        KConfig config( fileName, KConfig::SimpleConfig );
+        KConfigGroup( &config, "KDE" ).writeEntry( key, value );
+        QVERIFY( config.sync() );
+    }
+
+    //* remove configuration entry
+    void removeSetting( const QString& key, const QString& fileName )
+    {
+        KConfig config( fileName, KConfig::SimpleConfig );
+        KConfigGroup( &config, "KDE" ).deleteEntry( key );
+        QVERIFY( config.sync() );
+    }
+
+    //* emulate KGlobalSettings::notifyChange
+    void notifyChange( Feren::Style& style )
+    {
+        // SettingsChanged, SETTINGS_STYLE
+        QVERIFY( QMetaObject::invokeMethod( &style, "kdeGlobalSettingsChanged", Q_ARG( int, 3 ), Q_ARG( int, 4 ) ) );
+    }
+
+    //* width of a push button with text and icon
+    int buttonWidth( const Feren::Style& style ) const
+    {
+        QPixmap pixmap( 16, 16 );
+        pixmap.fill( Qt::black );
+
+        QStyleOptionButton option;
+        option.text = QStringLiteral( "A push button with a fairly long label" );
+        option.icon = QIcon( pixmap );
+        option.iconSize = pixmap.size();
+        option.fontMetrics = QFontMetrics( QApplication::font() );
+        return style.sizeFromContents( QStyle::CT_PushButton, &option, QSize(), nullptr ).width();
+    }
+
+};
+
+QTEST_MAIN( FerenKdeGlobalsTest )
+
+#include "ferenkdeglobalstest.moc"
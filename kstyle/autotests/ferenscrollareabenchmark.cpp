@@ -0,0 +1,122 @@
+/*************************************************************************
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include "ferenscrollareacache.h"
+#include "ferenstyle.h"
+
+#include <QApplication>
+#include <QScrollArea>
+#include <QScrollBar>
+#include <QTest>
+
+//* scrollbar lookups on widgets holding many children
+class FerenScrollAreaBenchmark: public QObject
+{
+
+    Q_OBJECT
+
+    private Q_SLOTS:
+
+    //* scrollbar containers, looked up on every paint event of a scroll area
+    void containers_data()
+    {
+        QTest::addColumn<bool>( "cached" );
+        QTest::newRow( "findChild" ) << false;
+        QTest::newRow( "cached" ) << true;
+    }
+
+    void containers()
+    {
+        QFETCH( bool, cached );
+
+        QScrollArea scrollArea;
+        scrollArea.setWidget( createChildren() );
+
+        Feren::ScrollAreaCache cache( nullptr );
+        cache.registerWidget( &scrollArea );
+        QCOMPARE( cache.containers( &scrollArea ).size(), 2 );
+
+        QBENCHMARK
+        {
+            if( cached ) cache.containers( &scrollArea );
+            else {
+                scrollArea.findChild<QWidget*>( QStringLiteral( "qt_scrollarea_vcontainer" ) );
+                scrollArea.findChild<QWidget*>( QStringLiteral( "qt_scrollarea_hcontainer" ) );
+            }
+        }
+    }
+
+    //* scrollbars of a widget managing its own, like KTextEditor::View, looked up on every mouse move
+    void scrollBars_data()
+    {
+        QTest::addColumn<bool>( "cached" );
+        QTest::newRow( "findChildren" ) << false;
+        QTest::newRow( "cached" ) << true;
+    }
+
+    void scrollBars()
+    {
+        QFETCH( bool, cached );
+
+        QWidget view;
+        QWidget* children( createChildren() );
+        children->setParent( &view );
+        new QScrollBar( Qt::Vertical, children );
+
+        Feren::ScrollAreaCache cache( nullptr );
+        cache.registerWidget( &view );
+        QCOMPARE( cache.scrollBars( &view ).size(), 1 );
+
+        QBENCHMARK
+        {
+            if( cached ) cache.scrollBars( &view );
+            else view.findChildren<QScrollBar*>();
+        }
+    }
+
+    //* repaint of a polished scroll area, including the style's event filter
+    void paint()
+    {
+        QApplication::setStyle( new Feren::Style );
+
+        QScrollArea scrollArea;
+        scrollArea.setWidget( createChildren() );
+        scrollArea.resize( 400, 300 );
+        scrollArea.show();
+        QVERIFY( QTest::qWaitForWindowExposed( &scrollArea ) );
+
+        QBENCHMARK
+        { scrollArea.repaint(); }
+    }
+
+    private:
+
+    //* widget holding 10k children
+    static QWidget* createChildren()
+    {
+        QWidget* widget( new QWidget );
+        for( int index = 0; index < 10000; ++index )
+        { new QWidget( widget ); }
+
+        return widget;
+    }
+
+};
+
+QTEST_MAIN( FerenScrollAreaBenchmark )
+
+#include "ferenscrollareabenchmark.moc"
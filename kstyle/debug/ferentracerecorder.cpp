@@ -0,0 +1,192 @@
+/*************************************************************************
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include "ferentracerecorder.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+
+#include <time.h>
+
+namespace Feren
+{
+
+    //* recorded event
+    class TraceEvent
+    {
+        public:
+
+        const char* category = nullptr;
+        const char* name = nullptr;
+        const char* detail = nullptr;
+        qint64 start = 0;
+        qint64 duration = 0;
+
+    };
+
+    //* per thread ring buffer
+    /** only the owning thread writes. Buffers are never deleted, so that events survive the thread */
+    class TraceBuffer
+    {
+        public:
+
+        //* capacity
+        enum { Capacity = 1<<16 };
+
+        //* events
+        QVector<TraceEvent> events = QVector<TraceEvent>( Capacity );
+
+        //* number of events recorded so far, including overwritten ones
+        std::atomic<quint64> count{ 0 };
+
+        //* thread id
+        quintptr threadId = 0;
+
+    };
+
+    //* recording state
+    std::atomic<bool> TraceRecorder::_enabled{ false };
+
+    //* output file
+    static QString traceFileName;
+
+    //* all buffers, guarded by traceMutex
+    static QList<TraceBuffer*> traceBuffers;
+    static QMutex traceMutex;
+
+    //* current thread's buffer
+    static thread_local TraceBuffer* threadTraceBuffer = nullptr;
+
+    //_____________________________________________________
+    void TraceRecorder::initialize()
+    {
+        static bool initialized = false;
+        if( initialized ) return;
+        initialized = true;
+
+        traceFileName = QFile::decodeName( qgetenv( "FEREN_STYLE_TRACE" ) );
+        if( traceFileName.isEmpty() ) return;
+
+        qAddPostRoutine( TraceRecorder::flush );
+        _enabled.store( true );
+    }
+
+    //_____________________________________________________
+    qint64 TraceRecorder::now()
+    {
+        // absolute monotonic time, so that traces line up with system wide ones
+        timespec time;
+        clock_gettime( CLOCK_MONOTONIC, &time );
+        return qint64( time.tv_sec )*1000000000 + time.tv_nsec;
+    }
+
+    //_____________________________________________________
+    void TraceRecorder::record( const char* category, const char* name, const char* detail, qint64 start, qint64 duration )
+    {
+
+        TraceBuffer* buffer( threadTraceBuffer );
+        if( !buffer )
+        {
+            buffer = new TraceBuffer;
+            buffer->threadId = quintptr( QThread::currentThreadId() );
+
+            QMutexLocker locker( &traceMutex );
+            traceBuffers.append( buffer );
+            threadTraceBuffer = buffer;
+        }
+
+        const quint64 index( buffer->count.load( std::memory_order_relaxed ) );
+        TraceEvent& event( buffer->events[index%TraceBuffer::Capacity] );
+        event.category = category;
+        event.name = name ? name:"Custom";
+        event.detail = detail;
+        event.start = start;
+        event.duration = duration;
+        buffer->count.store( index + 1, std::memory_order_release );
+
+    }
+
+    //_____________________________________________________
+    void TraceRecorder::flush()
+    {
+
+        if( !_enabled.exchange( false ) ) return;
+
+        QFile file( traceFileName );
+        if( !file.open( QIODevice::WriteOnly|QIODevice::Truncate ) )
+        {
+            qWarning( "Feren::TraceRecorder::flush - cannot write %s", qPrintable( traceFileName ) );
+            return;
+        }
+
+        const QByteArray pid( QByteArray::number( QCoreApplication::applicationPid() ) );
+
+        QByteArray out( "{\"traceEvents\":[" );
+        bool first = true;
+
+        QMutexLocker locker( &traceMutex );
+        for( const TraceBuffer* buffer : qAsConst( traceBuffers ) )
+        {
+
+            // events still being recorded by other threads at exit may be torn, which is harmless here
+            const quint64 count( buffer->count.load( std::memory_order_acquire ) );
+            const quint64 begin( count > TraceBuffer::Capacity ? count - TraceBuffer::Capacity:0 );
+            const QByteArray tid( QByteArray::number( buffer->threadId ) );
+
+            for( quint64 index = begin; index < count; ++index )
+            {
+                const TraceEvent& event( buffer->events[index%TraceBuffer::Capacity] );
+
+                if( !first ) out += ',';
+                first = false;
+
+                out += "\n{\"name\":\"";
+                out += event.name;
+                out += "\",\"cat\":\"";
+                out += event.category;
+                out += "\",\"ph\":\"X\",\"ts\":";
+                out += QByteArray::number( event.start/1000.0, 'f', 3 );
+                out += ",\"dur\":";
+                out += QByteArray::number( event.duration/1000.0, 'f', 3 );
+                out += ",\"pid\":";
+                out += pid;
+                out += ",\"tid\":";
+                out += tid;
+                if( event.detail )
+                {
+                    out += ",\"args\":{\"detail\":\"";
+                    out += event.detail;
+                    out += "\"}";
+                }
+                out += '}';
+            }
+
+            // write as we go to keep memory bounded
+            file.write( out );
+            out.clear();
+
+        }
+
+        file.write( "\n]}\n" );
+
+    }
+
+}
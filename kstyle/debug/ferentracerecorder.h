@@ -0,0 +1,109 @@
+#ifndef ferentracerecorder_h
+#define ferentracerecorder_h
+
+/*************************************************************************
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include <QMetaEnum>
+#include <QtGlobal>
+
+#include <atomic>
+
+namespace Feren
+{
+
+    //* record style activity as chrome trace events
+    /**
+    recording is enabled by setting FEREN_STYLE_TRACE to a file name. Each thread records into its own
+    fixed size ring buffer, without locking, and all buffers are written to the file when the application exits.
+    The file can be loaded in chrome://tracing or Perfetto. Timestamps use CLOCK_MONOTONIC, so that they
+    line up with other traces of the same session. Recorded strings are not copied: they must be
+    string literals, class names or enum keys from the meta object system
+    */
+    class TraceRecorder
+    {
+
+        public:
+
+        //* read environment and schedule writing the file at exit. Only the first call has any effect
+        static void initialize();
+
+        //* true if recording
+        static bool enabled()
+        { return _enabled.load( std::memory_order_relaxed ); }
+
+        //* write recorded events to file, and stop recording
+        static void flush();
+
+        //* record the duration of a scope
+        class Span
+        {
+
+            public:
+
+            //* constructor
+            Span( const char* category, const char* name, const char* detail = nullptr ):
+                _category( category ),
+                _name( name ),
+                _detail( detail ),
+                _start( enabled() ? now():-1 )
+            {}
+
+            //* constructor, from a registered enum value, such as a style element
+            template<typename T>
+            Span( const char* category, T value ):
+                _category( category ),
+                _name( enabled() ? QMetaEnum::fromType<T>().valueToKey( value ):nullptr ),
+                _start( enabled() ? now():-1 )
+            {}
+
+            //* destructor
+            ~Span()
+            { if( _start >= 0 ) record( _category, _name, _detail, _start, now() - _start ); }
+
+            private:
+
+            //* category
+            const char* _category = nullptr;
+
+            //* name
+            const char* _name = nullptr;
+
+            //* detail
+            const char* _detail = nullptr;
+
+            //* start time, negative when not recording
+            qint64 _start = -1;
+
+        };
+
+        private:
+
+        //* CLOCK_MONOTONIC time, in nanoseconds
+        static qint64 now();
+
+        //* record one event in current thread's buffer
+        static void record( const char* category, const char* name, const char* detail, qint64 start, qint64 duration );
+
+        //* recording state
+        static std::atomic<bool> _enabled;
+
+    };
+
+}
+
+#endif
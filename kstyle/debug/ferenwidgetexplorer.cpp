@@ -20,6 +20,8 @@
 #include "ferenwidgetexplorer.h"
 
 #include "feren.h"
+#include "ferenanimations.h"
+#include "ferenconfigdata.h"
 
 #include <QTextStream>
 #include <QApplication>
@@ -29,6 +31,15 @@
 namespace Feren
 {
 
+    //* number of frames over which paint time is averaged
+    static const int FrameCount = 30;
+
+    //* paint time, in milliseconds, above which a widget is shown in plain red
+    static const qreal FrameBudget = 8.0;
+
+    //* minimum interval between two updates of running animations, in milliseconds
+    static const int AnimationsUpdateInterval = 100;
+
     //________________________________________________
     WidgetExplorer::WidgetExplorer( QObject* parent ):
         QObject( parent )
@@ -60,6 +71,28 @@ namespace Feren
 
         qApp->removeEventFilter( this );
         if( _enabled )  qApp->installEventFilter( this );
+        updateRecording();
+    }
+
+    //________________________________________________
+    void WidgetExplorer::setMode( int mode )
+    {
+        _paintStatistics = ( mode == StyleConfigData::WE_PAINT_STATISTICS );
+        updateRecording();
+    }
+
+    //________________________________________________
+    void WidgetExplorer::updateRecording()
+    {
+        _recording = _enabled && _paintStatistics;
+        if( _recording ) return;
+
+        // drop statistics
+        for( auto iter = _statistics.constBegin(); iter != _statistics.constEnd(); ++iter )
+        { disconnect( iter.key(), nullptr, this, nullptr ); }
+
+        _statistics.clear();
+        _runningAnimations.clear();
     }
 
     //________________________________________________
@@ -79,8 +112,17 @@ namespace Feren
         switch( event->type() )
         {
             case QEvent::Paint:
-            if( _drawWidgetRects )
+            if( _recording )
             {
+                // let paint events delivered by paintStatistics go through
+                QWidget* widget( qobject_cast<QWidget*>( object ) );
+                if( !widget || _painting.contains( widget ) ) return false;
+
+                paintStatistics( widget, event );
+                return true;
+
+            } else if( _drawWidgetRects ) {
+
                 QWidget* widget( qobject_cast<QWidget*>( object ) );
                 if( !widget ) return false;
 
@@ -131,6 +173,122 @@ namespace Feren
 
     }
 
+    //________________________________________________
+    void WidgetExplorer::paintStatistics( QWidget* widget, QEvent* event )
+    {
+
+        // find statistics, and make sure they get removed with the widget
+        auto iter( _statistics.find( widget ) );
+        if( iter == _statistics.end() )
+        {
+            iter = _statistics.insert( widget, Statistics() );
+            connect( widget, &QObject::destroyed, this, &WidgetExplorer::widgetDestroyed );
+        }
+
+        iter->current = 0;
+        iter->repaints.increment();
+
+        // deliver event. Style paint calls get accounted to this widget
+        _painting.append( widget );
+        QCoreApplication::sendEvent( widget, event );
+        _painting.removeLast();
+
+        // the widget may have been deleted or statistics rehashed while painting
+        iter = _statistics.find( widget );
+        if( iter == _statistics.end() ) return;
+
+        iter->commit();
+        paintOverlay( widget );
+
+    }
+
+    //________________________________________________
+    void WidgetExplorer::paintOverlay( QWidget* widget )
+    {
+
+        // OpenGL and native painting cannot be overlaid
+        if( widget->testAttribute( Qt::WA_PaintOnScreen ) ) return;
+
+        // update running animations
+        if( _animations && ( !_runningAnimationsTimer.isValid() || _runningAnimationsTimer.elapsed() >= AnimationsUpdateInterval ) )
+        {
+            _runningAnimations = _animations->runningAnimations();
+            _runningAnimationsTimer.start();
+        }
+
+        const Statistics& statistics( _statistics[widget] );
+        const qreal average( statistics.average() );
+        const int animations( _runningAnimations.value( widget ) );
+
+        QPainter painter( widget );
+        const QRect rect( widget->rect() );
+
+        // widgets that are not painted by the style are left untouched
+        if( average > 0 || animations > 0 )
+        {
+
+            const qreal ratio( qMin<qreal>( 1.0, average/FrameBudget ) );
+            QColor color( QColor::fromHsvF( ( 1.0 - ratio )/3, 1.0, 1.0 ) );
+            color.setAlphaF( 0.15 + 0.35*ratio );
+            painter.fillRect( rect, color );
+
+            // label
+            QString label( QStringLiteral( "%1 ms  %2/s" ).arg( average, 0, 'f', 2 ).arg( statistics.repaints.rate() ) );
+            if( animations > 0 ) label += QStringLiteral( "  %1 anim" ).arg( animations );
+
+            const QFontMetrics metrics( widget->font() );
+            const QRect textRect( rect.topLeft(), metrics.size( Qt::TextSingleLine, label ) + QSize( 4, 2 ) );
+            if( rect.contains( textRect ) )
+            {
+                painter.fillRect( textRect, QColor( 255, 255, 255, 200 ) );
+                painter.setPen( Qt::black );
+                painter.drawText( textRect, Qt::AlignCenter, label );
+            }
+
+        }
+
+        if( _drawWidgetRects )
+        {
+            painter.setBrush( Qt::NoBrush );
+            painter.setPen( Qt::red );
+            painter.drawRect( rect.adjusted( 0, 0, -1, -1 ) );
+        }
+
+    }
+
+    //________________________________________________
+    void WidgetExplorer::addPaintTime( const QWidget* widget, qint64 nsecs )
+    {
+
+        // account to the widget whose paint event is being delivered, if any,
+        // since style calls made while painting a viewport usually pass the view
+        if( !_painting.isEmpty() ) widget = _painting.last();
+
+        auto iter( _statistics.find( widget ) );
+        if( iter != _statistics.end() ) iter->current += nsecs;
+
+    }
+
+    //________________________________________________
+    void WidgetExplorer::Statistics::commit()
+    {
+        if( frames.size() < FrameCount ) frames.append( current );
+        else frames[next] = current;
+
+        next = ( next + 1 )%FrameCount;
+        current = 0;
+    }
+
+    //________________________________________________
+    qreal WidgetExplorer::Statistics::average() const
+    {
+        if( frames.isEmpty() ) return 0;
+
+        qint64 total = 0;
+        for( qint64 frame : frames ) total += frame;
+        return qreal( total )/frames.size()/1e6;
+    }
+
     //________________________________________________
     QString WidgetExplorer::eventType( const QEvent::Type& type ) const
     {
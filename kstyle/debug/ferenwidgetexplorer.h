@@ -20,16 +20,29 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
  *************************************************************************/
 
+#include "fereninvocationcounter.h"
+
+#include <QElapsedTimer>
 #include <QEvent>
+#include <QHash>
 #include <QObject>
 #include <QMap>
 #include <QSet>
+#include <QVector>
 #include <QWidget>
 
 namespace Feren
 {
 
+    //* forward declaration
+    class Animations;
+
     //* print widget's and parent's information on mouse click
+    /**
+    in paint statistics mode, widgets are instead tinted from green to red according to the time
+    spent in style paint calls over the last frames, and labeled with their repaint rate
+    and number of running animations
+    */
     class WidgetExplorer: public QObject
     {
 
@@ -50,6 +63,48 @@ namespace Feren
         void setDrawWidgetRects( bool value )
         { _drawWidgetRects = value; }
 
+        //* mode
+        void setMode( int );
+
+        //* animations, used to show running animations in paint statistics mode
+        void setAnimations( const Animations* animations )
+        { _animations = animations; }
+
+        //* measure time spent in a style paint call
+        /** only the outermost call is measured, so that nested style calls are not counted twice */
+        class PaintTimer
+        {
+            public:
+
+            //* constructor
+            PaintTimer( WidgetExplorer* explorer, const QWidget* widget ):
+                _explorer( explorer ),
+                _widget( widget )
+            {
+                if( !( _explorer->_recording && _widget ) ) _explorer = nullptr;
+                else if( _explorer->_paintDepth++ == 0 ) _timer.start();
+            }
+
+            //* destructor
+            ~PaintTimer()
+            {
+                if( _explorer && --_explorer->_paintDepth == 0 )
+                { _explorer->addPaintTime( _widget, _timer.nsecsElapsed() ); }
+            }
+
+            private:
+
+            //* explorer, null when not recording
+            WidgetExplorer* _explorer = nullptr;
+
+            //* widget
+            const QWidget* _widget = nullptr;
+
+            //* timer
+            QElapsedTimer _timer;
+
+        };
+
         //* event filter
         bool eventFilter( QObject*, QEvent* ) override;
 
@@ -61,14 +116,81 @@ namespace Feren
         //* print widget information
         QString widgetInformation( const QWidget* ) const;
 
+        //* deliver paint event to widget, measure style paint time, and paint overlay on top
+        void paintStatistics( QWidget*, QEvent* );
+
+        //* paint overlay
+        void paintOverlay( QWidget* );
+
+        //* add time spent in style paint call, in nanoseconds
+        void addPaintTime( const QWidget*, qint64 );
+
+        protected Q_SLOTS:
+
+        //* remove statistics for destroyed widget
+        void widgetDestroyed( QObject* object )
+        { _statistics.remove( object ); }
+
         private:
 
+        //* update recording state
+        void updateRecording();
+
+        //* paint statistics
+        class Statistics
+        {
+            public:
+
+            //* commit current frame
+            void commit();
+
+            //* average paint time over recorded frames, in milliseconds
+            qreal average() const;
+
+            //* style paint time for the frame being painted, in nanoseconds
+            qint64 current = 0;
+
+            //* style paint time for the last frames, in nanoseconds
+            QVector<qint64> frames;
+
+            //* next frame index
+            int next = 0;
+
+            //* repaints
+            InvocationCounter repaints;
+
+        };
+
         //* enable state
         bool _enabled = false;
 
         //* widget rects
         bool _drawWidgetRects = false;
 
+        //* paint statistics mode
+        bool _paintStatistics = false;
+
+        //* true when style paint calls must be measured
+        bool _recording = false;
+
+        //* style paint call nesting depth
+        int _paintDepth = 0;
+
+        //* widgets whose paint event is being delivered, innermost last
+        QVector<const QWidget*> _painting;
+
+        //* statistics, per widget
+        QHash<const QObject*, Statistics> _statistics;
+
+        //* animations
+        const Animations* _animations = nullptr;
+
+        //* running animations, per widget
+        QHash<const QWidget*, int> _runningAnimations;
+
+        //* last update of running animations
+        QElapsedTimer _runningAnimationsTimer;
+
         //* map event types to string
         QMap<QEvent::Type, QString > _eventTypes;
 
@@ -222,6 +222,16 @@ namespace Feren
 
     Q_DECLARE_FLAGS( Sides, Side )
 
+    //* tree branch lines
+    enum TreeBranch
+    {
+        TreeBranchTop = 0x1,
+        TreeBranchSide = 0x2,
+        TreeBranchBottom = 0x4
+    };
+
+    Q_DECLARE_FLAGS( TreeBranches, TreeBranch )
+
     //* checkbox state
     enum CheckBoxState
     {
@@ -264,5 +274,6 @@ namespace Feren
 Q_DECLARE_OPERATORS_FOR_FLAGS( Feren::AnimationModes )
 Q_DECLARE_OPERATORS_FOR_FLAGS( Feren::Corners )
 Q_DECLARE_OPERATORS_FOR_FLAGS( Feren::Sides )
+Q_DECLARE_OPERATORS_FOR_FLAGS( Feren::TreeBranches )
 
 #endif
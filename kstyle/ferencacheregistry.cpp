@@ -0,0 +1,140 @@
+/*************************************************************************
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include "ferencacheregistry.h"
+
+#include <algorithm>
+
+namespace Feren
+{
+
+    //____________________________________________________________________
+    CacheRegistry::Id CacheRegistry::registerCache( const QString& name, CostFunction cost, ClearFunction clear, CostFunction reclaimableCost )
+    {
+        const Id id( _nextId++ );
+        Entry& entry( _entries[id] );
+        entry.statistics.name = name;
+        entry.costFunction = std::move( cost );
+        entry.clearFunction = std::move( clear );
+        entry.reclaimableCostFunction = std::move( reclaimableCost );
+        entry.lastUse = ++_useCounter;
+        return id;
+    }
+
+    //____________________________________________________________________
+    void CacheRegistry::unregisterCache( Id id )
+    {
+        auto iter( _entries.find( id ) );
+        if( iter == _entries.end() ) return;
+        _totalCost -= iter->cost;
+        _entries.erase( iter );
+    }
+
+    //____________________________________________________________________
+    void CacheRegistry::hit( Id id )
+    {
+        auto iter( _entries.find( id ) );
+        if( iter == _entries.end() ) return;
+        ++iter->statistics.hits;
+        iter->lastUse = ++_useCounter;
+    }
+
+    //____________________________________________________________________
+    void CacheRegistry::miss( Id id )
+    {
+        auto iter( _entries.find( id ) );
+        if( iter == _entries.end() ) return;
+        ++iter->statistics.misses;
+        iter->lastUse = ++_useCounter;
+    }
+
+    //____________________________________________________________________
+    void CacheRegistry::inserted( Id id, qint64 cost )
+    {
+        auto iter( _entries.find( id ) );
+        if( iter == _entries.end() ) return;
+        iter->lastUse = ++_useCounter;
+        setCost( *iter, cost );
+        enforceBudget( id );
+    }
+
+    //____________________________________________________________________
+    void CacheRegistry::removed( Id id, qint64 cost )
+    {
+        auto iter( _entries.find( id ) );
+        if( iter != _entries.end() ) setCost( *iter, cost );
+    }
+
+    //____________________________________________________________________
+    void CacheRegistry::purge()
+    {
+        for( Entry& entry : _entries )
+        { setCost( entry, entry.clearFunction() ); }
+
+        ++_purgeCount;
+    }
+
+    //____________________________________________________________________
+    QList<CacheRegistry::Statistics> CacheRegistry::statistics() const
+    {
+        QList<Statistics> out;
+        for( const Entry& entry : _entries )
+        {
+            Statistics statistics( entry.statistics );
+            statistics.cost = entry.costFunction();
+            statistics.reclaimableCost = entry.reclaimableCostFunction ? entry.reclaimableCostFunction():statistics.cost;
+            out.append( statistics );
+        }
+
+        return out;
+    }
+
+    //____________________________________________________________________
+    void CacheRegistry::enforceBudget( Id skipped )
+    {
+
+        if( _totalCost <= _budget ) return;
+
+        // order caches by last use
+        QList<Entry*> entries;
+        for( auto iter = _entries.begin(); iter != _entries.end(); ++iter )
+        { if( iter.key() != skipped ) entries.append( &iter.value() ); }
+        std::sort( entries.begin(), entries.end(), []( const Entry* first, const Entry* second )
+            { return first->lastUse < second->lastUse; } );
+
+        // clear least recently used first
+        for( Entry* entry : entries )
+        {
+            const qint64 cost( entry->cost );
+            if( cost <= 0 ) continue;
+
+            // caches may keep content that is still in use
+            setCost( *entry, entry->clearFunction() );
+            if( entry->cost < cost ) ++entry->statistics.evictions;
+            if( _totalCost <= _budget ) return;
+        }
+
+    }
+
+    //____________________________________________________________________
+    void CacheRegistry::setCost( Entry& entry, qint64 cost )
+    {
+        _totalCost += cost - entry.cost;
+        entry.cost = cost;
+    }
+
+}
@@ -0,0 +1,188 @@
+#ifndef ferencacheregistry_h
+#define ferencacheregistry_h
+
+/*************************************************************************
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include <functional>
+
+namespace Feren
+{
+
+    //* keeps track of all style level caches, and bounds the memory they hold together
+    /**
+    each cache reports its accesses through hit and miss, and the bytes it holds whenever its content changes,
+    through inserted and removed, so that the budget is enforced without querying every cache.
+    Cost callbacks are only used for statistics.
+    When the total cost exceeds the budget after an insertion, other caches are cleared as a whole,
+    least recently used first, until the total fits again. The cache being inserted into is never cleared
+    at this point, since its caller may still hold references to its content; it is bounded by its own limits
+    */
+    class CacheRegistry
+    {
+
+        public:
+
+        //* cache id
+        using Id = int;
+
+        //* callback returning the bytes held by a cache
+        using CostFunction = std::function<qint64()>;
+
+        //* callback dropping the content of a cache, and returning the bytes it still holds
+        /** caches may keep content that is still in use */
+        using ClearFunction = std::function<qint64()>;
+
+        //* register cache
+        /** when no reclaimable cost callback is given, all the cache content is considered reclaimable */
+        Id registerCache( const QString& name, CostFunction cost, ClearFunction clear, CostFunction reclaimableCost = CostFunction() );
+
+        //* unregister cache
+        void unregisterCache( Id );
+
+        //* cache lookup succeeded
+        void hit( Id );
+
+        //* cache lookup failed
+        void miss( Id );
+
+        //* content was added to a cache, which now holds cost bytes
+        void inserted( Id, qint64 cost );
+
+        //* content was dropped by a cache on its own, which now holds cost bytes
+        void removed( Id, qint64 cost );
+
+        //* drop the content of all caches
+        void purge();
+
+        //*@name configuration
+        //@{
+
+        //* maximum number of bytes held by all caches together
+        void setBudget( qint64 value )
+        {
+            _budget = value;
+            enforceBudget();
+        }
+
+        //* maximum number of bytes held by all caches together
+        qint64 budget() const
+        { return _budget; }
+
+        //@}
+
+        //*@name statistics
+        //@{
+
+        //* per cache statistics
+        class Statistics
+        {
+            public:
+
+            //* name
+            QString name;
+
+            //* bytes held
+            qint64 cost = 0;
+
+            //* bytes that clearing the cache would release
+            qint64 reclaimableCost = 0;
+
+            //* lookups served from the cache
+            qint64 hits = 0;
+
+            //* lookups not served from the cache
+            qint64 misses = 0;
+
+            //* number of times the cache was cleared to fit the budget
+            int evictions = 0;
+
+        };
+
+        //* statistics of all registered caches
+        QList<Statistics> statistics() const;
+
+        //* bytes held by all caches, as last reported by them
+        qint64 totalCost() const
+        { return _totalCost; }
+
+        //* number of purges
+        int purgeCount() const
+        { return _purgeCount; }
+
+        //@}
+
+        private:
+
+        //* clear least recently used caches until the total cost fits the budget
+        void enforceBudget( Id skipped = -1 );
+
+        //* registered cache
+        class Entry
+        {
+            public:
+
+            //* statistics
+            Statistics statistics;
+
+            //* bytes held, as last reported
+            qint64 cost = 0;
+
+            //* cost callback
+            CostFunction costFunction;
+
+            //* reclaimable cost callback
+            CostFunction reclaimableCostFunction;
+
+            //* clear callback
+            ClearFunction clearFunction;
+
+            //* last access, from the registry use counter
+            quint64 lastUse = 0;
+
+        };
+
+        //* update cost of a given cache, and total cost
+        void setCost( Entry&, qint64 );
+
+        //* entries
+        QHash<Id, Entry> _entries;
+
+        //* next cache id
+        Id _nextId = 0;
+
+        //* use counter, used to order caches by last access
+        quint64 _useCounter = 0;
+
+        //* bytes held by all caches
+        qint64 _totalCost = 0;
+
+        //* budget
+        qint64 _budget = 64*1024*1024;
+
+        //* purges
+        int _purgeCount = 0;
+
+    };
+
+}
+
+#endif
@@ -27,7 +27,9 @@
 #include <KWindowSystem>
 
 #include <QApplication>
+#include <QPaintEngine>
 #include <QPainter>
+#include <QtMath>
 
 #if FEREN_HAVE_X11
 #include <QX11Info>
@@ -41,10 +43,79 @@ namespace Feren
     //* contrast for arrow and treeline rendering
     static const qreal arrowShade = 0.15;
 
+    //* sub-pixel steps used to position cached arrow glyphs
+    static const int arrowGlyphSteps = 4;
+
+    //____________________________________________________________________
+    static QPolygonF arrowPolygon( ArrowOrientation orientation )
+    {
+        switch( orientation )
+        {
+            /* The inner points of the normal arrows are not on half pixels because
+             * they need to have an even width (up/down) or height (left/right).
+             * An even width/height makes them easier to align with other UI elements.
+             */
+            case ArrowUp: return QVector<QPointF>{QPointF( -4.5, 1.5 ), QPointF( 0, -3 ), QPointF( 4.5, 1.5 )};
+            case ArrowDown: return QVector<QPointF>{QPointF( -4.5, -1.5 ), QPointF( 0, 3 ), QPointF( 4.5, -1.5 )};
+            case ArrowLeft: return QVector<QPointF>{QPointF( 1.5, -4.5 ), QPointF( -3, 0 ), QPointF( 1.5, 4.5 )};
+            case ArrowRight: return QVector<QPointF>{QPointF( -1.5, -4.5 ), QPointF( 3, 0 ), QPointF( -1.5, 4.5 )};
+            case ArrowDown_Small: return QVector<QPointF>{QPointF( 1.5, 3.5 ), QPointF( 3.5, 5.5 ), QPointF( 5.5, 3.5 )};
+            default: return QPolygonF();
+        }
+    }
+
+    //____________________________________________________________________
+    static int pixmapCost( const QPixmap& pixmap )
+    { return qMax( 1, pixmap.width()*pixmap.height()*pixmap.depth()/8 ); }
+
+    //____________________________________________________________________
+    static QPen arrowPen( const QColor& color )
+    {
+        QPen pen( color, PenWidth::Symbol );
+        pen.setCapStyle(Qt::SquareCap);
+        pen.setJoinStyle(Qt::MiterJoin);
+        return pen;
+    }
+
+    //____________________________________________________________________
+    static int arrowGlyphSize( ArrowOrientation orientation )
+    {
+        // even sized square, centered on the arrow origin, holding the stroked polygon and its antialiasing
+        const QRectF bounds( arrowPolygon( orientation ).boundingRect() );
+        const qreal extent( qMax(
+            qMax( qAbs( bounds.left() ), qAbs( bounds.right() ) ),
+            qMax( qAbs( bounds.top() ), qAbs( bounds.bottom() ) ) ) + PenWidth::Symbol + 1 );
+        return 2*qCeil( extent );
+    }
+
     //____________________________________________________________________
     Helper::Helper( KSharedConfig::Ptr config ):
         _config( std::move( config ) )
-    {}
+    {
+
+        // cache costs are in bytes
+        _arrowAtlas.setMaxCost( 1024*1024 );
+        _treeBranchCache.setMaxCost( 2*1024*1024 );
+        _coloredIconCache.setMaxCost( 8*1024*1024 );
+
+        // register caches
+        _arrowAtlasId = _cacheRegistry.registerCache( QStringLiteral( "ArrowAtlas" ),
+            [this]() { return qint64( _arrowAtlas.totalCost() ); },
+            [this]() { _arrowAtlas.clear(); return qint64( 0 ); } );
+
+        _treeBranchCacheId = _cacheRegistry.registerCache( QStringLiteral( "TreeBranches" ),
+            [this]() { return qint64( _treeBranchCache.totalCost() ); },
+            [this]() { _treeBranchCache.clear(); return qint64( 0 ); } );
+
+        _coloredIconCacheId = _cacheRegistry.registerCache( QStringLiteral( "ColoredIcons" ),
+            [this]() { return qint64( _coloredIconCache.totalCost() ); },
+            [this]() { _coloredIconCache.clear(); return qint64( 0 ); } );
+
+        _imagePool.setCacheRegistry( &_cacheRegistry, _cacheRegistry.registerCache( QStringLiteral( "ImagePool" ),
+            [this]() { return _imagePool.cost(); },
+            [this]() { _imagePool.clear(); return qint64( 0 ); } ) );
+
+    }
 
     //____________________________________________________________________
     KSharedConfig::Ptr Helper::config() const
@@ -57,6 +128,9 @@ namespace Feren
         _viewHoverBrush = KStatefulBrush( KColorScheme::View, KColorScheme::HoverColor );
         _viewNegativeTextBrush = KStatefulBrush( KColorScheme::View, KColorScheme::NegativeText );
 
+        // recolored icons depend on the color scheme
+        clearColoredIconCache();
+
         const QPalette palette( QApplication::palette() );
         const KConfigGroup group( _config->group( "WM" ) );
         _activeTitleBarColor = group.readEntry( "activeBackground", palette.color( QPalette::Active, QPalette::Highlight ) );
@@ -161,6 +235,22 @@ namespace Feren
 
     }
 
+    //____________________________________________________________________
+    QColor Helper::treeLineColor( const QPalette& palette ) const
+    {
+        // mixing is comparatively expensive, and called for every branch cell
+        const QRgb base( palette.color( QPalette::Base ).rgba() );
+        const QRgb text( palette.color( QPalette::Text ).rgba() );
+        if( !_treeLineColor.isValid() || base != _treeLineBase || text != _treeLineText )
+        {
+            _treeLineBase = base;
+            _treeLineText = text;
+            _treeLineColor = KColorUtils::mix( QColor::fromRgba( base ), QColor::fromRgba( text ), 0.25 );
+        }
+
+        return _treeLineColor;
+    }
+
     //____________________________________________________________________
     QColor Helper::arrowColor( const QPalette& palette, bool mouseOver, bool hasFocus, qreal opacity, AnimationMode mode ) const
     {
@@ -1281,34 +1371,184 @@ namespace Feren
 
     //______________________________________________________________________________
     void Helper::renderArrow( QPainter* painter, const QRect& rect, const QColor& color, ArrowOrientation orientation ) const
+    {
+
+        if( orientation == ArrowNone ) return;
+
+        // glyphs are only blitted for translated raster painters on integer scaled devices
+        const QTransform& transform( painter->transform() );
+        const qreal dpr( painter->device() ? painter->device()->devicePixelRatioF() : 1.0 );
+        if( transform.type() > QTransform::TxTranslate ||
+            dpr != qRound( dpr ) ||
+            !painter->paintEngine() ||
+            painter->paintEngine()->type() != QPaintEngine::Raster )
+        { return renderArrowPath( painter, rect, color, orientation ); }
+
+        // split arrow center, in device independent pixels, into an integer position and a sub-pixel offset
+        const QPointF center( QRectF( rect ).center() );
+        const QPointF mapped( transform.map( center ) );
+        const int x( qFloor( mapped.x()*arrowGlyphSteps ) );
+        const int y( qFloor( mapped.y()*arrowGlyphSteps ) );
+        const QPoint origin( qFloor( qreal( x )/arrowGlyphSteps ), qFloor( qreal( y )/arrowGlyphSteps ) );
+        const QPoint offset( x - origin.x()*arrowGlyphSteps, y - origin.y()*arrowGlyphSteps );
+
+        // glyphs are rendered opaque, and faded at blit time, so that fading arrows share a single glyph
+        const int size( arrowGlyphSize( orientation ) );
+        const QPixmap pixmap( arrowPixmap( QColor( color.rgb() ), orientation, size, offset, dpr ) );
+        const qreal opacity( painter->opacity() );
+        painter->setOpacity( opacity*color.alphaF() );
+        painter->drawPixmap( transform.inverted().map( QPointF( origin ) ) - QPointF( size/2, size/2 ), pixmap );
+        painter->setOpacity( opacity );
+
+    }
+
+    //______________________________________________________________________________
+    void Helper::renderArrowPath( QPainter* painter, const QRect& rect, const QColor& color, ArrowOrientation orientation ) const
     {
         // define polygon
-        QPolygonF arrow;
-        switch( orientation )
-        {
-            /* The inner points of the normal arrows are not on half pixels because
-             * they need to have an even width (up/down) or height (left/right).
-             * An even width/height makes them easier to align with other UI elements.
-             */
-            case ArrowUp: arrow = QVector<QPointF>{QPointF( -4.5, 1.5 ), QPointF( 0, -3 ), QPointF( 4.5, 1.5 )}; break;
-            case ArrowDown: arrow = QVector<QPointF>{QPointF( -4.5, -1.5 ), QPointF( 0, 3 ), QPointF( 4.5, -1.5 )}; break;
-            case ArrowLeft: arrow = QVector<QPointF>{QPointF( 1.5, -4.5 ), QPointF( -3, 0 ), QPointF( 1.5, 4.5 )}; break;
-            case ArrowRight: arrow = QVector<QPointF>{QPointF( -1.5, -4.5 ), QPointF( 3, 0 ), QPointF( -1.5, 4.5 )}; break;
-            case ArrowDown_Small: arrow = QVector<QPointF>{QPointF( 1.5, 3.5 ), QPointF( 3.5, 5.5 ), QPointF( 5.5, 3.5 )}; break;
-            default: break;
-        }
+        const QPolygonF arrow( arrowPolygon( orientation ) );
 
         painter->save();
         painter->setRenderHints( QPainter::Antialiasing );
         painter->translate( QRectF( rect ).center() );
         painter->setBrush( Qt::NoBrush );
-        QPen pen( color, PenWidth::Symbol );
-        pen.setCapStyle(Qt::SquareCap);
-        pen.setJoinStyle(Qt::MiterJoin);
-        painter->setPen( pen );
+        painter->setPen( arrowPen( color ) );
         painter->drawPolyline( arrow );
         painter->restore();
-   }
+    }
+
+    //______________________________________________________________________________
+    void Helper::renderTreeBranch( QPainter* painter, const QRect& rect, const QColor& color, TreeBranches branches, int expanderAdjust, bool reverseLayout ) const
+    {
+
+        if( !branches || !rect.isValid() ) return;
+
+        // pixmaps are only blitted for translated raster painters on integer scaled devices
+        const qreal dpr( painter->device() ? painter->device()->devicePixelRatioF() : 1.0 );
+        if( painter->transform().type() > QTransform::TxTranslate ||
+            dpr != qRound( dpr ) || dpr > 7 ||
+            !painter->paintEngine() ||
+            painter->paintEngine()->type() != QPaintEngine::Raster ||
+            rect.width() > 1023 || rect.height() > 1023 || expanderAdjust < 0 || expanderAdjust > 31 )
+        { return renderTreeBranchLines( painter, rect, color, branches, expanderAdjust, reverseLayout ); }
+
+        // pixmaps are rendered opaque, and faded at blit time, so that fading lines share a single pixmap
+        const QColor opaque( color.rgb() );
+        const quint64 key(
+            ( quint64( opaque.rgba() ) << 32 ) |
+            ( quint64( rect.width() ) << 22 ) |
+            ( quint64( rect.height() ) << 12 ) |
+            ( quint64( branches ) << 9 ) |
+            ( quint64( reverseLayout ) << 8 ) |
+            ( quint64( expanderAdjust ) << 3 ) |
+            quint64( qRound( dpr ) ) );
+
+        QPixmap pixmap;
+        if( QPixmap* cached = _treeBranchCache.object( key ) )
+        {
+
+            pixmap = *cached;
+            _cacheRegistry.hit( _treeBranchCacheId );
+
+        } else {
+
+            _cacheRegistry.miss( _treeBranchCacheId );
+
+            pixmap = QPixmap( rect.size()*dpr );
+            pixmap.setDevicePixelRatio( dpr );
+            pixmap.fill( Qt::transparent );
+
+            QPainter local( &pixmap );
+            renderTreeBranchLines( &local, QRect( QPoint(), rect.size() ), opaque, branches, expanderAdjust, reverseLayout );
+            local.end();
+
+            _treeBranchCache.insert( key, new QPixmap( pixmap ), pixmapCost( pixmap ) );
+            _cacheRegistry.inserted( _treeBranchCacheId, _treeBranchCache.totalCost() );
+
+        }
+
+        const qreal opacity( painter->opacity() );
+        painter->setOpacity( opacity*color.alphaF() );
+        painter->drawPixmap( rect.topLeft(), pixmap );
+        painter->setOpacity( opacity );
+
+    }
+
+    //______________________________________________________________________________
+    void Helper::renderTreeBranchLines( QPainter* painter, const QRect& rect, const QColor& color, TreeBranches branches, int expanderAdjust, bool reverseLayout ) const
+    {
+
+        const auto center( rect.center() );
+        painter->save();
+        painter->setRenderHint( QPainter::Antialiasing, true );
+        painter->translate( 0.5, 0.5 );
+        painter->setPen( QPen( color, 1 ) );
+        if( branches & TreeBranchTop )
+        {
+            const QLineF line( QPointF( center.x(), rect.top() ), QPointF( center.x(), center.y() - expanderAdjust - 1 ) );
+            painter->drawLine( line );
+        }
+
+        // The right/left (depending on direction) line gets drawn if we have an item
+        if( branches & TreeBranchSide )
+        {
+            const QLineF line = reverseLayout ?
+                QLineF( QPointF( rect.left(), center.y() ), QPointF( center.x() - expanderAdjust, center.y() ) ):
+                QLineF( QPointF( center.x() + expanderAdjust, center.y() ), QPointF( rect.right(), center.y() ) );
+            painter->drawLine( line );
+
+        }
+
+        // The bottom if we have a sibling
+        if( branches & TreeBranchBottom )
+        {
+            const QLineF line( QPointF( center.x(), center.y() + expanderAdjust ), QPointF( center.x(), rect.bottom() ) );
+            painter->drawLine( line );
+        }
+
+        painter->restore();
+
+    }
+
+    //______________________________________________________________________________
+    QPixmap Helper::arrowPixmap( const QColor& color, ArrowOrientation orientation, int size, const QPoint& offset, qreal devicePixelRatio ) const
+    {
+
+        const quint64 key(
+            ( quint64( color.rgba() ) << 32 ) |
+            ( quint64( orientation ) << 28 ) |
+            ( quint64( size & 0xff ) << 20 ) |
+            ( quint64( offset.x() ) << 18 ) |
+            ( quint64( offset.y() ) << 16 ) |
+            ( quint64( qRound( devicePixelRatio ) ) & 0xffff ) );
+
+        if( QPixmap* cached = _arrowAtlas.object( key ) )
+        {
+            _cacheRegistry.hit( _arrowAtlasId );
+            return *cached;
+        }
+
+        _cacheRegistry.miss( _arrowAtlasId );
+
+        QPixmap pixmap( QSize( size, size )*devicePixelRatio );
+        pixmap.setDevicePixelRatio( devicePixelRatio );
+        pixmap.fill( Qt::transparent );
+
+        QPainter painter( &pixmap );
+        painter.setRenderHints( QPainter::Antialiasing );
+        painter.translate(
+            size/2 + qreal( offset.x() )/arrowGlyphSteps,
+            size/2 + qreal( offset.y() )/arrowGlyphSteps );
+        painter.setBrush( Qt::NoBrush );
+        painter.setPen( arrowPen( color ) );
+        painter.drawPolyline( arrowPolygon( orientation ) );
+        painter.end();
+
+        _arrowAtlas.insert( key, new QPixmap( pixmap ), pixmapCost( pixmap ) );
+        _cacheRegistry.inserted( _arrowAtlasId, _arrowAtlas.totalCost() );
+        return pixmap;
+
+    }
 
     //______________________________________________________________________________
     void Helper::renderDecorationButton( QPainter* painter, const QRect& rect, const QColor& color, ButtonType buttonType, bool inverted ) const
@@ -1581,6 +1821,24 @@ namespace Feren
 
     QPixmap Helper::coloredIcon(const QIcon& icon,  const QPalette& palette, const QSize &size, QIcon::Mode mode, QIcon::State state)
     {
+        if( icon.isNull() ) return QPixmap();
+
+        ColoredIconKey key;
+        key.icon = icon.cacheKey();
+        key.palette = palette.cacheKey();
+        key.size = size;
+        key.mode = mode;
+        key.state = state;
+        key.devicePixelRatio = qApp->devicePixelRatio();
+
+        if( QPixmap* cached = _coloredIconCache.object( key ) )
+        {
+            _cacheRegistry.hit( _coloredIconCacheId );
+            return *cached;
+        }
+
+        _cacheRegistry.miss( _coloredIconCacheId );
+
         const QPalette activePalette = KIconLoader::global()->customPalette();
         const bool changePalette = activePalette != palette;
         if (changePalette) {
@@ -1594,6 +1852,9 @@ namespace Feren
                 KIconLoader::global()->setCustomPalette(activePalette);
             }
         }
+
+        _coloredIconCache.insert( key, new QPixmap( pixmap ), pixmapCost( pixmap ) );
+        _cacheRegistry.inserted( _coloredIconCacheId, _coloredIconCache.totalCost() );
         return pixmap;
     }
 }
@@ -23,11 +23,14 @@
 
 #include "feren.h"
 #include "ferenanimationdata.h"
+#include "ferencacheregistry.h"
+#include "ferenimagepool.h"
 #include "config-feren.h"
 
 #include <KColorScheme>
 #include <KSharedConfig>
 
+#include <QCache>
 #include <QPainterPath>
 #include <QIcon>
 #include <QWidget>
@@ -116,6 +119,9 @@ namespace Feren
         QColor arrowColor( const QPalette& palette, QPalette::ColorRole role ) const
         { return arrowColor( palette, palette.currentColorGroup(), role ); }
 
+        //* tree branch line color
+        QColor treeLineColor( const QPalette& ) const;
+
         //* arrow outline color, using animations
         QColor arrowColor( const QPalette&, bool mouseOver, bool hasFocus, qreal opacity = AnimationData::OpacityInvalid, AnimationMode = AnimationNone ) const;
 
@@ -236,8 +242,12 @@ namespace Feren
         void renderTabBarTab( QPainter*, const QRect&, const QColor& color, const QColor& outline, Corners ) const;
 
         //* generic arrow
+        /** blitted from the glyph atlas, unless the painter is scaled, rotated or not a raster painter */
         void renderArrow( QPainter*, const QRect&, const QColor&, ArrowOrientation ) const;
 
+        //* tree branch lines, blitted from cached pixmaps when the painter transformation allows it
+        void renderTreeBranch( QPainter*, const QRect&, const QColor&, TreeBranches, int expanderAdjust, bool reverseLayout ) const;
+
         //* generic button (for mdi decorations, tabs and dock widgets)
         void renderDecorationButton( QPainter*, const QRect&, const QColor&, ButtonType, bool inverted ) const;
 
@@ -283,11 +293,41 @@ namespace Feren
         //* return a QRectF with the appropriate size for a rectangle with a pen stroke
         QRectF strokedRect( const QRect &rect, const int penWidth = PenWidth::Frame ) const;
         
+        //* icon pixmap, recolored with a given palette
+        /**
+        pixmaps are cached by icon, palette, size, mode, state and device pixel ratio,
+        so that the global icon loader palette only gets changed on cache misses
+        */
         QPixmap coloredIcon(const QIcon &icon, const QPalette& palette, const QSize &size,
                             QIcon::Mode mode = QIcon::Normal, QIcon::State state = QIcon::Off);
 
+        //* drop cached colored icons
+        /** must be called on palette or icon theme change */
+        void clearColoredIconCache()
+        {
+            _coloredIconCache.clear();
+            _cacheRegistry.removed( _coloredIconCacheId, 0 );
+        }
+
+        //* pool of temporary images and pixmaps
+        ImagePool& imagePool() const
+        { return _imagePool; }
+
+        //* registry of all style level caches
+        CacheRegistry& cacheRegistry() const
+        { return _cacheRegistry; }
+
         protected:
 
+        //* stroke tree branch lines
+        void renderTreeBranchLines( QPainter*, const QRect&, const QColor&, TreeBranches, int expanderAdjust, bool reverseLayout ) const;
+
+        //* stroke arrow polygon
+        void renderArrowPath( QPainter*, const QRect&, const QColor&, ArrowOrientation ) const;
+
+        //* arrow glyph for a given color, orientation, glyph size, sub-pixel offset and device pixel ratio
+        QPixmap arrowPixmap( const QColor&, ArrowOrientation, int size, const QPoint& offset, qreal devicePixelRatio ) const;
+
         //* return rounded path in a given rect, with only selected corners rounded, and for a given radius
         QPainterPath roundedPath( const QRectF&, Corners, qreal ) const;
 
@@ -311,6 +351,72 @@ namespace Feren
         QColor _inactiveTitleBarTextColor;
         //@}
 
+        //* cache registry
+        /** declared first, so that it outlives the caches it references */
+        mutable CacheRegistry _cacheRegistry;
+
+        //* temporary images and pixmaps
+        mutable ImagePool _imagePool;
+
+        //* arrow glyph atlas, each glyph rasterized once
+        mutable QCache<quint64, QPixmap> _arrowAtlas;
+
+        //* arrow glyph atlas id in cache registry
+        CacheRegistry::Id _arrowAtlasId = -1;
+
+        //* tree branch pixmaps
+        mutable QCache<quint64, QPixmap> _treeBranchCache;
+
+        //* tree branch cache id in cache registry
+        CacheRegistry::Id _treeBranchCacheId = -1;
+
+        //*@name last tree line color, and the colors it was mixed from
+        //@{
+        mutable QRgb _treeLineBase = 0;
+        mutable QRgb _treeLineText = 0;
+        mutable QColor _treeLineColor;
+        //@}
+
+        //* colored icon cache key
+        class ColoredIconKey
+        {
+            public:
+
+            //* equal to operator
+            bool operator == ( const ColoredIconKey& other ) const
+            {
+                return
+                    icon == other.icon &&
+                    palette == other.palette &&
+                    size == other.size &&
+                    mode == other.mode &&
+                    state == other.state &&
+                    devicePixelRatio == other.devicePixelRatio;
+            }
+
+            //* hash
+            friend uint qHash( const ColoredIconKey& key, uint seed = 0 )
+            {
+                return ::qHash( key.icon, seed ) ^ ::qHash( key.palette, seed ) ^
+                    ::qHash( ( key.size.width() << 16 ) ^ key.size.height(), seed ) ^
+                    ::qHash( ( key.mode << 4 ) | key.state, seed ) ^ ::qHash( key.devicePixelRatio, seed );
+            }
+
+            qint64 icon = 0;
+            qint64 palette = 0;
+            QSize size;
+            int mode = 0;
+            int state = 0;
+            qreal devicePixelRatio = 1;
+
+        };
+
+        //* colored icons
+        QCache<ColoredIconKey, QPixmap> _coloredIconCache;
+
+        //* colored icon cache id in cache registry
+        CacheRegistry::Id _coloredIconCacheId = -1;
+
     };
 
 }
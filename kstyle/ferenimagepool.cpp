@@ -0,0 +1,215 @@
+/*************************************************************************
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include "ferenimagepool.h"
+
+#include <QGuiApplication>
+#include <QPaintEngine>
+#include <QPointer>
+#include <QScreen>
+#include <QTimerEvent>
+
+namespace Feren
+{
+
+    //* granularity of size classes (pixels)
+    static const int SizeClassStep = 64;
+
+    //* pooled buffer lent to a returned image
+    class ImagePoolLease
+    {
+        public:
+
+        //* pool, if still alive
+        QPointer<ImagePool> pool;
+
+        //* pooled buffer
+        QImage buffer;
+
+    };
+
+    //____________________________________________________________________
+    ImagePool::ImagePool( QObject* parent ):
+        QObject( parent )
+    {
+        if( qobject_cast<QGuiApplication*>( qApp ) )
+        {
+            connect( qApp, &QGuiApplication::screenAdded, this, &ImagePool::updateHighWaterMark );
+            connect( qApp, &QGuiApplication::screenRemoved, this, &ImagePool::updateHighWaterMark );
+        }
+
+        updateHighWaterMark();
+    }
+
+    //____________________________________________________________________
+    QImage ImagePool::image( const QSize& size, QImage::Format format )
+    {
+        bool reused( false );
+        const QImage image( lease( size, format, reused ) );
+        if( reused ) ++_reuseCount;
+        return image;
+    }
+
+    //____________________________________________________________________
+    QPixmap ImagePool::pixmap( const QSize& size )
+    {
+        bool reused( false );
+        QImage image( lease( size, QImage::Format_ARGB32_Premultiplied, reused ) );
+        const uchar* bits( image.constBits() );
+
+        // raster pixmaps adopt the image data, so that the pooled buffer is kept for the pixmap's lifetime.
+        // Opaque detection would convert opaque buffers to another format, which copies them.
+        // Other backends copy the data, and the buffer goes back to the pool right away
+        const QPixmap pixmap( QPixmap::fromImage( std::move( image ), Qt::NoOpaqueDetection ) );
+        if( reused && adopts( pixmap, bits ) ) ++_reuseCount;
+        return pixmap;
+    }
+
+    //____________________________________________________________________
+    bool ImagePool::adopts( const QPixmap& pixmap, const uchar* bits )
+    {
+        // raster pixmaps share their image data, as long as no painter is active on them
+        QPaintEngine* engine( pixmap.paintEngine() );
+        return bits && engine && engine->type() == QPaintEngine::Raster && pixmap.toImage().constBits() == bits;
+    }
+
+    //____________________________________________________________________
+    QImage ImagePool::lease( const QSize& size, QImage::Format format, bool& reused )
+    {
+
+        if( size.isEmpty() ) return QImage( size, format );
+
+        // find or allocate buffer for size class
+        QImage buffer;
+        auto iter( _images.find( key( sizeClass( size ), format ) ) );
+        if( iter != _images.end() && !iter->isEmpty() )
+        {
+            buffer = iter->takeLast();
+            _cost -= qint64( buffer.bytesPerLine() )*buffer.height();
+            reused = true;
+            if( _registry )
+            {
+                _registry->hit( _registryId );
+                _registry->removed( _registryId, _cost );
+            }
+
+        } else {
+
+            buffer = QImage( sizeClass( size ), format );
+            if( buffer.isNull() ) return buffer;
+            ++_allocationCount;
+            if( _registry ) _registry->miss( _registryId );
+
+        }
+
+        // return an image of the requested size, sharing the buffer's data. The buffer is recycled once the image is gone
+        ImagePoolLease* lease( new ImagePoolLease );
+        lease->pool = this;
+        lease->buffer.swap( buffer );
+        return QImage( lease->buffer.bits(), size.width(), size.height(), lease->buffer.bytesPerLine(), format, &ImagePool::leaseEnded, lease );
+
+    }
+
+    //____________________________________________________________________
+    void ImagePool::release( QImage& image )
+    { image = QImage(); }
+
+    //____________________________________________________________________
+    void ImagePool::release( QPixmap& pixmap )
+    { pixmap = QPixmap(); }
+
+    //____________________________________________________________________
+    void ImagePool::clear()
+    {
+        _images.clear();
+        _cost = 0;
+        _idleTimer.stop();
+        if( _registry ) _registry->removed( _registryId, 0 );
+    }
+
+    //____________________________________________________________________
+    void ImagePool::timerEvent( QTimerEvent* event )
+    {
+        if( event->timerId() == _idleTimer.timerId() ) clear();
+        else QObject::timerEvent( event );
+    }
+
+    //____________________________________________________________________
+    void ImagePool::updateHighWaterMark()
+    {
+        if( _highWaterMarkSet ) return;
+
+        // room for two full screen frames on the largest screen
+        qint64 frameCost = 0;
+        if( qobject_cast<QGuiApplication*>( qApp ) )
+        {
+            for( const QScreen* screen : QGuiApplication::screens() )
+            {
+                const QSize size( sizeClass( ( QSizeF( screen->size() )*screen->devicePixelRatio() ).toSize() ) );
+                frameCost = qMax( frameCost, qint64( size.width() )*size.height()*4 );
+            }
+        }
+
+        // stay within the pool share of the cache budget, so that recycled buffers do not evict other caches
+        _highWaterMark = qMin( _budget, qMax<qint64>( 32*1024*1024, 2*frameCost ) );
+        if( _cost > _highWaterMark ) clear();
+    }
+
+    //____________________________________________________________________
+    QSize ImagePool::sizeClass( const QSize& size )
+    {
+        auto round = []( int value ) { return ( ( value + SizeClassStep - 1 )/SizeClassStep )*SizeClassStep; };
+        return QSize( round( size.width() ), round( size.height() ) );
+    }
+
+    //____________________________________________________________________
+    quint64 ImagePool::key( const QSize& size, int format )
+    {
+        return
+            ( quint64( format ) << 48 ) |
+            ( quint64( size.width()&0xffffff ) << 24 ) |
+            quint64( size.height()&0xffffff );
+    }
+
+    //____________________________________________________________________
+    void ImagePool::recycle( const QImage& buffer )
+    {
+
+        QList<QImage>& images( _images[key( buffer.size(), buffer.format() )] );
+        if( images.size() >= MaxBuffers ) return;
+
+        const qint64 cost( qint64( buffer.bytesPerLine() )*buffer.height() );
+        if( _cost + cost > _highWaterMark ) return;
+
+        images.append( buffer );
+        _cost += cost;
+        if( _registry ) _registry->inserted( _registryId, _cost );
+
+        // restart idle timer
+        _idleTimer.start( _idleTimeout, this );
+
+    }
+
+    //____________________________________________________________________
+    void ImagePool::leaseEnded( void* info )
+    {
+        ImagePoolLease* lease( static_cast<ImagePoolLease*>( info ) );
+        if( lease->pool ) lease->pool->recycle( lease->buffer );
+        delete lease;
+    }
+
+}
@@ -0,0 +1,195 @@
+#ifndef ferenimagepool_h
+#define ferenimagepool_h
+
+/*************************************************************************
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include "ferencacheregistry.h"
+
+#include <QBasicTimer>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QObject>
+#include <QPixmap>
+
+namespace Feren
+{
+
+    //* pool of temporary images and pixmaps
+    /**
+    buffers are allocated by size classes, rounded up from the requested size, and handed out again
+    once released, so that rendering done on every frame, or for a widget being resized, does not need new allocations.
+    Returned images and pixmaps have the exact requested size, and share the data of the larger pooled buffer.
+    The buffer goes back to the pool once the last copy of the returned image or pixmap is gone.
+    The pool is emptied when it has not been used for a while, and never holds more than a given number of bytes,
+    by default enough for two full screen frames, within its share of the cache budget. Returned buffers have undefined content.
+    */
+    class ImagePool: public QObject
+    {
+
+        Q_OBJECT
+
+        public:
+
+        //* constructor
+        explicit ImagePool( QObject* parent = nullptr );
+
+        //* get image of given size and format
+        QImage image( const QSize&, QImage::Format = QImage::Format_ARGB32_Premultiplied );
+
+        //* get pixmap of given size
+        /** the pixmap has an alpha channel, whatever the content of the pooled buffer */
+        QPixmap pixmap( const QSize& );
+
+        //* give image back to the pool
+        /** image is cleared. Its buffer is reused once no other copy remains */
+        void release( QImage& );
+
+        //* give pixmap back to the pool
+        /** pixmap is cleared. Its buffer is reused once no other copy remains */
+        void release( QPixmap& );
+
+        //* drop all buffers
+        void clear();
+
+        //*@name configuration
+        //@{
+
+        //* maximum number of bytes held by the pool
+        /** overrides the default, derived from screen sizes */
+        void setHighWaterMark( qint64 value )
+        {
+            _highWaterMark = value;
+            _highWaterMarkSet = true;
+            if( _cost > _highWaterMark ) clear();
+        }
+
+        //* maximum number of bytes held by the pool
+        qint64 highWaterMark() const
+        { return _highWaterMark; }
+
+        //* share of the cache budget the pool may use, in bytes
+        /** the default high water mark never exceeds it */
+        void setBudget( qint64 value )
+        {
+            _budget = value;
+            updateHighWaterMark();
+        }
+
+        //* delay after which an unused pool is emptied (msec)
+        void setIdleTimeout( int value )
+        { _idleTimeout = value; }
+
+        //* registry to which accesses are reported
+        void setCacheRegistry( CacheRegistry* registry, CacheRegistry::Id id )
+        {
+            _registry = registry;
+            _registryId = id;
+        }
+
+        //@}
+
+        //*@name statistics
+        //@{
+
+        //* number of buffers that had to be allocated
+        qint64 allocationCount() const
+        { return _allocationCount; }
+
+        //* number of buffers that were served from the pool
+        /** for pixmaps, only buffers that the pixmap actually adopted are counted */
+        qint64 reuseCount() const
+        { return _reuseCount; }
+
+        //* number of bytes currently held
+        qint64 cost() const
+        { return _cost; }
+
+        //@}
+
+        protected:
+
+        //* timer event, used to trim the pool when idle
+        void timerEvent( QTimerEvent* ) override;
+
+        protected Q_SLOTS:
+
+        //* update default high water mark from screen sizes
+        void updateHighWaterMark();
+
+        private:
+
+        //* size class, rounded up from requested size
+        static QSize sizeClass( const QSize& );
+
+        //* size class key
+        static quint64 key( const QSize&, int format );
+
+        //* find or allocate buffer for a given size, and return an image sharing its data
+        QImage lease( const QSize&, QImage::Format, bool& reused );
+
+        //* true if pixmap uses the given image data rather than a copy
+        static bool adopts( const QPixmap&, const uchar* bits );
+
+        //* put buffer back to the pool, if within limits
+        void recycle( const QImage& );
+
+        //* called when the last copy of a returned image is gone
+        static void leaseEnded( void* );
+
+        //* maximum number of buffers per size class
+        enum { MaxBuffers = 4 };
+
+        //* pooled buffers, per size class
+        QHash<quint64, QList<QImage>> _images;
+
+        //* cache registry
+        CacheRegistry* _registry = nullptr;
+
+        //* id in cache registry
+        CacheRegistry::Id _registryId = -1;
+
+        //* high water mark
+        qint64 _highWaterMark = 32*1024*1024;
+
+        //* true if high water mark was set explicitly
+        bool _highWaterMarkSet = false;
+
+        //* share of the cache budget
+        qint64 _budget = 32*1024*1024;
+
+        //* idle timeout
+        int _idleTimeout = 5000;
+
+        //* idle timer
+        QBasicTimer _idleTimer;
+
+        //* bytes held
+        qint64 _cost = 0;
+
+        //* allocations
+        qint64 _allocationCount = 0;
+
+        //* reuses
+        qint64 _reuseCount = 0;
+
+    };
+
+}
+
+#endif
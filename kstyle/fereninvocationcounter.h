@@ -0,0 +1,74 @@
+#ifndef fereninvocationcounter_h
+#define fereninvocationcounter_h
+
+/*************************************************************************
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include <QElapsedTimer>
+#include <QtGlobal>
+
+namespace Feren
+{
+
+    //* counts invocations of a code path, such as an event filter
+    class InvocationCounter
+    {
+
+        public:
+
+        //* record one invocation
+        void increment()
+        {
+            if( !_timer.isValid() ) _timer.start();
+            else if( _timer.elapsed() >= 1000 )
+            {
+                _rate = _current;
+                _current = 0;
+                _timer.restart();
+            }
+
+            ++_current;
+            ++_total;
+        }
+
+        //* total number of invocations
+        qint64 total() const
+        { return _total; }
+
+        //* number of invocations during the last complete second
+        int rate() const
+        { return _rate; }
+
+        private:
+
+        //* timer
+        QElapsedTimer _timer;
+
+        //* invocations in the current second
+        int _current = 0;
+
+        //* invocations in the last complete second
+        int _rate = 0;
+
+        //* total invocations
+        qint64 _total = 0;
+
+    };
+
+}
+
+#endif
@@ -0,0 +1,156 @@
+/*************************************************************************
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include "ferenitemviewrowspans.h"
+
+#include <QAbstractItemView>
+#include <QEvent>
+#include <QHeaderView>
+#include <QPainter>
+#include <QStyleOptionViewItem>
+#include <QTableView>
+#include <QTreeView>
+
+namespace Feren
+{
+
+    //____________________________________________________________________________________
+    void ItemViewRowSpans::registerWidget( QAbstractItemView* view )
+    {
+
+        if( !view || !view->viewport() ) return;
+
+        QWidget* viewport( view->viewport() );
+        if( _viewports.contains( viewport ) ) return;
+        _viewports.insert( viewport, view );
+
+        // reset spans on paint events, and catch object destruction
+        viewport->installEventFilter( this );
+        connect( viewport, &QObject::destroyed, this, &ItemViewRowSpans::widgetDestroyed, Qt::UniqueConnection );
+
+    }
+
+    //____________________________________________________________________________________
+    void ItemViewRowSpans::unregisterWidget( QWidget* widget )
+    {
+
+        auto view( qobject_cast<QAbstractItemView*>( widget ) );
+        if( !( view && view->viewport() ) ) return;
+
+        QWidget* viewport( view->viewport() );
+        if( !_viewports.remove( viewport ) ) return;
+        viewport->removeEventFilter( this );
+        disconnect( viewport, &QObject::destroyed, this, &ItemViewRowSpans::widgetDestroyed );
+        if( _span.device == viewport ) _span = Span();
+
+    }
+
+    //____________________________________________________________________________________
+    bool ItemViewRowSpans::isBatched( const QAbstractItemView* view, const QPainter* painter ) const
+    {
+        // cells painted to pixmaps, for instance for drag and drop, are left alone
+        if( !( view && painter ) ) return false;
+        const QWidget* viewport( view->viewport() );
+        return viewport && painter->device() == viewport && _viewports.contains( viewport );
+    }
+
+    //____________________________________________________________________________________
+    bool ItemViewRowSpans::isCovered( const QPainter* painter, const QRect& rect, quint64 key )
+    {
+        ++_cellCount;
+        return _span.device == painter->device() && _span.key == key && _span.rect.contains( rect );
+    }
+
+    //____________________________________________________________________________________
+    bool ItemViewRowSpans::contains( const QPainter* painter, const QRect& rect ) const
+    { return _span.device == painter->device() && _span.rect.contains( rect ); }
+
+    //____________________________________________________________________________________
+    void ItemViewRowSpans::setSpan( const QPainter* painter, const QRect& rect, quint64 key )
+    {
+        ++_fillCount;
+        _span.device = painter->device();
+        _span.rect = rect;
+        _span.key = key;
+    }
+
+    //____________________________________________________________________________________
+    QRect ItemViewRowSpans::rowSpan( const QAbstractItemView* view, const QStyleOptionViewItem& option, bool selected )
+    {
+
+        QRect span( option.rect );
+        const QModelIndex& index( option.index );
+        if( !index.isValid() ) return span;
+
+        // columns are only known for views with a horizontal header
+        const auto tableView( qobject_cast<const QTableView*>( view ) );
+        const QHeaderView* header( nullptr );
+        if( tableView ) header = tableView->horizontalHeader();
+        else if( auto treeView = qobject_cast<const QTreeView*>( view ) ) header = treeView->header();
+        if( !header ) return span;
+
+        // table spans are painted before other cells, and must not be painted over
+        const int row( index.row() );
+        const auto isTableSpan = [tableView, row]( int column )
+        { return tableView && ( tableView->rowSpan( row, column ) > 1 || tableView->columnSpan( row, column ) > 1 ); };
+        if( isTableSpan( index.column() ) ) return span;
+
+        // grid lines are painted after cells, on the trailing edge of each cell
+        const bool reverse( option.direction == Qt::RightToLeft );
+        const int gap( tableView && tableView->showGrid() ? 1 : 0 );
+        const auto selectionModel( view->selectionModel() );
+
+        // extend over following columns, in painting order
+        for( int visualIndex = header->visualIndex( index.column() ) + 1; visualIndex < header->count(); ++visualIndex )
+        {
+
+            const int column( header->logicalIndex( visualIndex ) );
+            if( header->isSectionHidden( column ) ) continue;
+            if( isTableSpan( column ) ) break;
+            if( selected && !( selectionModel && selectionModel->isSelected( index.sibling( row, column ) ) ) ) break;
+
+            // cell extent, in viewport coordinates
+            int left( header->sectionViewportPosition( column ) );
+            int right( left + header->sectionSize( column ) - 1 );
+            if( reverse ) left += gap;
+            else right -= gap;
+
+            span |= QRect( left, span.top(), right - left + 1, span.height() );
+
+        }
+
+        return span;
+
+    }
+
+    //____________________________________________________________________________________
+    bool ItemViewRowSpans::eventFilter( QObject* object, QEvent* event )
+    {
+        // a new paint pass starts. Previous spans are no longer on screen
+        if( event->type() == QEvent::Paint && _span.device == qobject_cast<QWidget*>( object ) ) _span = Span();
+        return false;
+    }
+
+    //____________________________________________________________________________________
+    void ItemViewRowSpans::widgetDestroyed( QObject* object )
+    {
+        // object is no longer a widget at this stage, so the span is reset unconditionally
+        _viewports.remove( object );
+        _span = Span();
+    }
+
+}
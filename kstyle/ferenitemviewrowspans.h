@@ -0,0 +1,133 @@
+#ifndef ferenitemviewrowspans_h
+#define ferenitemviewrowspans_h
+
+/*************************************************************************
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include <QHash>
+#include <QObject>
+#include <QRect>
+
+class QAbstractItemView;
+class QPaintDevice;
+class QPainter;
+class QStyleOptionViewItem;
+
+namespace Feren
+{
+
+    //* merges item view cell backgrounds into per-row spans
+    /**
+    when the first cell of a row is painted on a registered viewport, the alternate and selection
+    backgrounds are rendered once for the longest run of following cells that share them.
+    Following cells covered by this span, with the same background, are then skipped, and so are
+    the row fills of all covered cells.
+    Spans are reset on each viewport paint event
+    */
+    class ItemViewRowSpans: public QObject
+    {
+
+        Q_OBJECT
+
+        public:
+
+        //* constructor
+        explicit ItemViewRowSpans( QObject* parent ):
+            QObject( parent )
+        {}
+
+        //* register item view
+        void registerWidget( QAbstractItemView* );
+
+        //* unregister item view
+        void unregisterWidget( QWidget* );
+
+        //* true if painter renders a registered item view's viewport
+        bool isBatched( const QAbstractItemView*, const QPainter* ) const;
+
+        //* true if cell is fully covered by the current span, with the same background
+        bool isCovered( const QPainter*, const QRect&, quint64 key );
+
+        //* true if rect is fully covered by the current span, whatever its background
+        bool contains( const QPainter*, const QRect& ) const;
+
+        //* start a new span
+        void setSpan( const QPainter*, const QRect&, quint64 key );
+
+        //* row span starting at a given cell
+        /**
+        it extends in painting order over the following visible columns, and stops at table spans.
+        For selected cells, it also stops at the first unselected cell
+        */
+        static QRect rowSpan( const QAbstractItemView*, const QStyleOptionViewItem&, bool selected );
+
+        //*@name statistics
+        //@{
+
+        //* number of batched cells
+        int cellCount() const
+        { return _cellCount; }
+
+        //* number of fills issued for batched cells
+        int fillCount() const
+        { return _fillCount; }
+
+        //@}
+
+        //* event filter
+        bool eventFilter( QObject*, QEvent* ) override;
+
+        protected Q_SLOTS:
+
+        //* triggered by object destruction
+        void widgetDestroyed( QObject* );
+
+        private:
+
+        //* current span
+        class Span
+        {
+            public:
+
+            //* paint device
+            const QPaintDevice* device = nullptr;
+
+            //* rect
+            QRect rect;
+
+            //* background key
+            quint64 key = 0;
+
+        };
+
+        //* current span
+        Span _span;
+
+        //* registered viewports, and matching views
+        QHash<const QObject*, const QAbstractItemView*> _viewports;
+
+        //*@name statistics
+        //@{
+        int _cellCount = 0;
+        int _fillCount = 0;
+        //@}
+
+    };
+
+}
+
+#endif
@@ -33,13 +33,36 @@ namespace Feren
 {
 
     //____________________________________________________________________
-    MdiWindowShadow::MdiWindowShadow( QWidget* parent, const TileSet &shadowTiles ):
+    MdiWindowShadow::MdiWindowShadow( QWidget* parent, ShadowHelper* shadowHelper ):
         QWidget( parent ),
-        _shadowTiles( shadowTiles )
+        _shadowHelper( shadowHelper )
     {
         setAttribute( Qt::WA_OpaquePaintEvent, false );
         setAttribute( Qt::WA_TransparentForMouseEvents, true );
         setFocusPolicy( Qt::NoFocus );
+        updateDevicePixelRatio();
+    }
+
+    //____________________________________________________________________
+    MdiWindowShadow::~MdiWindowShadow()
+    {
+        if( _shadowHelper && _devicePixelRatio > 0 )
+        { _shadowHelper->shadowAtlas().release( _devicePixelRatio ); }
+    }
+
+    //____________________________________________________________________
+    void MdiWindowShadow::updateDevicePixelRatio()
+    {
+        if( !_shadowHelper ) return;
+
+        const qreal devicePixelRatio( devicePixelRatioF() );
+        if( devicePixelRatio == _devicePixelRatio ) return;
+
+        // acquire new variant before releasing the old one, to avoid evicting textures needed again
+        ShadowAtlas& atlas( _shadowHelper->shadowAtlas() );
+        atlas.acquire( devicePixelRatio );
+        if( _devicePixelRatio > 0 ) atlas.release( _devicePixelRatio );
+        _devicePixelRatio = devicePixelRatio;
     }
 
     //____________________________________________________________________
@@ -111,12 +134,18 @@ namespace Feren
     void MdiWindowShadow::paintEvent( QPaintEvent* event )
     {
 
-        if( !_shadowTiles.isValid() ) return;
+        if( !_shadowHelper ) return;
+
+        // window might have moved to a screen with different device pixel ratio
+        updateDevicePixelRatio();
+
+        const TileSet shadowTiles( _shadowHelper->shadowAtlas().tileSet( _devicePixelRatio ) );
+        if( !shadowTiles.isValid() ) return;
 
         QPainter painter( this );
         painter.setRenderHints( QPainter::Antialiasing );
         painter.setClipRegion( event->region() );
-        _shadowTiles.render( _shadowTilesRect, &painter );
+        shadowTiles.render( _shadowTilesRect, &painter );
 
     }
 
@@ -241,7 +270,7 @@ namespace Feren
         if ( !_shadowHelper ) return;
 
         // create new shadow
-        auto windowShadow( new MdiWindowShadow( widget->parentWidget(), _shadowHelper->shadowTiles() ) );
+        auto windowShadow( new MdiWindowShadow( widget->parentWidget(), _shadowHelper ) );
         windowShadow->setWidget( widget );
 
     }
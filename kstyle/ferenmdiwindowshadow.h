@@ -45,7 +45,10 @@ namespace Feren
         public:
 
         //* constructor
-        explicit MdiWindowShadow( QWidget*, const TileSet & );
+        explicit MdiWindowShadow( QWidget*, ShadowHelper* );
+
+        //* destructor
+        ~MdiWindowShadow() override;
 
         //* update geometry
         void updateGeometry();
@@ -68,14 +71,20 @@ namespace Feren
 
         private:
 
+        //* make sure the atlas entry matching current device pixel ratio is held
+        void updateDevicePixelRatio();
+
         //* associated widget
         QWidget* _widget = nullptr;
 
         //* tileset rect, used for painting
         QRect _shadowTilesRect;
 
-        //* tileset used to draw shadow
-        TileSet _shadowTiles;
+        //* shadow helper, holding the shared shadow atlas
+        QPointer<ShadowHelper> _shadowHelper;
+
+        //* device pixel ratio of the atlas entry currently held
+        qreal _devicePixelRatio = 0;
 
     };
 
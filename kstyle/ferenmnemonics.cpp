@@ -29,34 +29,41 @@ namespace Feren
     void Mnemonics::setMode( int mode )
     {
 
+        // text rects are only needed to repaint mnemonics on visibility change
+        _automatic = ( mode == StyleConfigData::MN_AUTO );
+        if( !_automatic ) clearEntries();
+
         switch( mode )
         {
             case StyleConfigData::MN_NEVER:
-            qApp->removeEventFilter( this );
+            uninstallEventFilter();
             setEnabled( false );
             break;
 
             default:
             case StyleConfigData::MN_ALWAYS:
-            qApp->removeEventFilter( this );
+            uninstallEventFilter();
             setEnabled( true );
             break;
 
             case StyleConfigData::MN_AUTO:
-            qApp->removeEventFilter( this );
-            qApp->installEventFilter( this );
+            // key events are delivered to the focus window first, there is no need to filter all application events
+            connect( qApp, &QGuiApplication::focusWindowChanged, this, &Mnemonics::focusWindowChanged, Qt::UniqueConnection );
+            connect( qApp, &QGuiApplication::applicationStateChanged, this, &Mnemonics::applicationStateChanged, Qt::UniqueConnection );
+            focusWindowChanged( QGuiApplication::focusWindow() );
             setEnabled( false );
             break;
 
         }
 
-        
     }
 
     //____________________________________________________
     bool Mnemonics::eventFilter( QObject*, QEvent* event )
     {
 
+        _eventFilterCounter.increment();
+
         switch( event->type() )
         {
 
@@ -70,10 +77,6 @@ namespace Feren
             { setEnabled( false ); }
             break;
 
-            case QEvent::ApplicationStateChange:
-            { setEnabled( false ); }
-            break;
-
             default: break;
 
         }
@@ -82,6 +85,67 @@ namespace Feren
 
     }
 
+    //____________________________________________________
+    void Mnemonics::focusWindowChanged( QWindow* window )
+    {
+        if( _window == window ) return;
+        if( _window ) _window.data()->removeEventFilter( this );
+
+        _window = window;
+        if( _window ) _window.data()->installEventFilter( this );
+    }
+
+    //____________________________________________________
+    void Mnemonics::applicationStateChanged( Qt::ApplicationState )
+    { setEnabled( false ); }
+
+    //____________________________________________________
+    void Mnemonics::uninstallEventFilter()
+    {
+        disconnect( qApp, &QGuiApplication::focusWindowChanged, this, &Mnemonics::focusWindowChanged );
+        disconnect( qApp, &QGuiApplication::applicationStateChanged, this, &Mnemonics::applicationStateChanged );
+        focusWindowChanged( nullptr );
+    }
+
+    //____________________________________________________
+    void Mnemonics::registerText( const QPainter* painter, const QRect& rect )
+    {
+
+        if( !_automatic ) return;
+
+        QPaintDevice* device( painter->device() );
+        if( !( device && device->devType() == QInternal::Widget ) ) return;
+
+        auto widget( static_cast<QWidget*>( device ) );
+        const QRect mapped( painter->transform().mapRect( rect ).adjusted( -1, -1, 1, 1 ) );
+
+        auto iter( _entries.find( widget ) );
+        if( iter == _entries.end() )
+        {
+
+            // new widget. Its entry is removed on destruction
+            Entry& entry( _entries[widget] );
+            entry.widget = widget;
+            entry.rect = mapped;
+            connect( widget, &QObject::destroyed, this, &Mnemonics::widgetDestroyed, Qt::UniqueConnection );
+
+        } else iter->rect |= mapped;
+
+    }
+
+    //____________________________________________________
+    void Mnemonics::widgetDestroyed( QObject* object )
+    { _entries.remove( object ); }
+
+    //____________________________________________________
+    void Mnemonics::clearEntries()
+    {
+        for( const Entry& entry : qAsConst( _entries ) )
+        { if( entry.widget ) disconnect( entry.widget.data(), &QObject::destroyed, this, &Mnemonics::widgetDestroyed ); }
+
+        _entries.clear();
+    }
+
     //____________________________________________________
     void Mnemonics::setEnabled( bool value )
     {
@@ -89,9 +153,12 @@ namespace Feren
 
         _enabled = value;
 
-        // update all top level widgets
-        foreach( QWidget* widget, qApp->topLevelWidgets() )
-        { widget->update(); }
+        // update text rects of widgets that rendered mnemonics.
+        // Tracking starts over, since these widgets register again when repainted
+        const auto entries( _entries );
+        clearEntries();
+        for( const Entry& entry : entries )
+        { if( entry.widget ) entry.widget.data()->update( entry.rect ); }
 
     }
 
@@ -21,10 +21,17 @@
  *************************************************************************/
 
 #include <QEvent>
+#include <QHash>
 #include <QObject>
 #include <QApplication>
+#include <QPainter>
+#include <QPointer>
+#include <QRect>
+#include <QWidget>
+#include <QWindow>
 
 #include "ferenconfigdata.h"
+#include "fereninvocationcounter.h"
 
 namespace Feren
 {
@@ -55,16 +62,69 @@ namespace Feren
         int textFlags() const
         { return _enabled ? Qt::TextShowMnemonic : Qt::TextHideMnemonic; }
 
+        //* register text containing mnemonics, rendered with given painter
+        /**
+        only widgets are tracked, and only in automatic mode, where mnemonics visibility changes.
+        Other paint devices are repainted along with their owner
+        */
+        void registerText( const QPainter*, const QRect& );
+
+        //* event filter invocations
+        const InvocationCounter& eventFilterCounter() const
+        { return _eventFilterCounter; }
+
+        protected Q_SLOTS:
+
+        //* move event filter to the new focus window
+        void focusWindowChanged( QWindow* );
+
+        //* hide mnemonics when application state changes
+        void applicationStateChanged( Qt::ApplicationState );
+
+        //* triggered by widget destruction
+        void widgetDestroyed( QObject* );
+
         protected:
 
         //* set enable state
         void setEnabled( bool );
 
+        //* stop listening to key events
+        void uninstallEventFilter();
+
+        //* forget widgets that rendered mnemonics
+        void clearEntries();
+
         private:
 
+        //* widget that rendered mnemonics
+        class Entry
+        {
+            public:
+
+            //* widget
+            QPointer<QWidget> widget;
+
+            //* area covered by text with mnemonics, in widget coordinates
+            QRect rect;
+
+        };
+
         //* enable state
         bool _enabled = true;
 
+        //* true in automatic mode
+        bool _automatic = false;
+
+        //* widgets that rendered mnemonics since last visibility change
+        QHash<const QObject*, Entry> _entries;
+
+        //* window on which the event filter is installed
+        QPointer<QWindow> _window;
+
+        //* event filter invocations
+        InvocationCounter _eventFilterCounter;
+
     };
 
 }
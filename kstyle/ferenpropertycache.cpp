@@ -0,0 +1,194 @@
+/*************************************************************************
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include "ferenpropertycache.h"
+
+#include "ferenpropertynames.h"
+
+#include <QAbstractItemView>
+#include <QEvent>
+#include <QMenu>
+#include <QToolButton>
+#include <QVariant>
+
+namespace Feren
+{
+
+    //____________________________________________________________________________________
+    void PropertyCache::registerWidget( QWidget* widget )
+    {
+
+        if( !widget ) return;
+        if( isRegistered( widget ) ) return;
+
+        // the event filter has a cost on every event. Only install it where cached properties are actually used
+        if( !isWatched( widget ) ) return;
+
+        // previously detected flags are superseded
+        _detected.remove( widget );
+
+        // read all properties right away
+        Flags& flags( _flags[widget] );
+        for( const QByteArray& name : widget->dynamicPropertyNames() )
+        { update( widget, name, flags ); }
+
+        // catch property changes and object destruction
+        widget->installEventFilter( this );
+        connect( widget, &QObject::destroyed, this, &PropertyCache::widgetDestroyed, Qt::UniqueConnection );
+
+    }
+
+    //____________________________________________________________________________________
+    void PropertyCache::unregisterWidget( QWidget* widget )
+    {
+        if( !widget ) return;
+
+        const bool registered( _flags.remove( widget ) );
+        if( !( _detected.remove( widget ) || registered ) ) return;
+        if( registered ) widget->removeEventFilter( this );
+        disconnect( widget, &QObject::destroyed, this, &PropertyCache::widgetDestroyed );
+    }
+
+    //____________________________________________________________________________________
+    bool PropertyCache::isWatched( const QWidget* widget )
+    {
+        return widget->isWindow() ||
+            qobject_cast<const QMenu*>( widget ) ||
+            qobject_cast<const QAbstractItemView*>( widget ) ||
+            qobject_cast<const QToolButton*>( widget );
+    }
+
+    //____________________________________________________________________________________
+    PropertyCache::Flags PropertyCache::flags( const QWidget* widget, Flags properties )
+    {
+        if( !widget ) return Flags();
+
+        auto iter( _flags.constFind( widget ) );
+        if( iter != _flags.constEnd() ) return iter.value();
+
+        if( isWatched( widget ) )
+        {
+            registerWidget( const_cast<QWidget*>( widget ) );
+            return _flags.value( widget );
+        }
+
+        // other widgets: read requested properties now, since changes are not tracked. Explicit properties override detected flags
+        Flags flags( _detected.value( widget ) );
+        for( const Flag flag : { SidePanelView, NoWindowGrab, NetWMSkipShadow, NetWMForceShadow, ToolButtonAlignLeft, MenuTitle, AlteredBackground } )
+        {
+            if( !properties.testFlag( flag ) ) continue;
+            const QVariant value( widget->property( propertyName( flag ) ) );
+            if( value.isValid() ) update( flag, value, flags );
+        }
+
+        return flags;
+    }
+
+    //____________________________________________________________________________________
+    void PropertyCache::setFlag( const QWidget* widget, Flag flag, bool value )
+    {
+        if( !widget ) return;
+        if( !isRegistered( widget ) ) registerWidget( const_cast<QWidget*>( widget ) );
+
+        // store detected flags separately for widgets that are not registered
+        Flags* target( nullptr );
+        auto iter( _flags.find( widget ) );
+        if( iter != _flags.end() ) target = &iter.value();
+        else {
+
+            if( !_detected.contains( widget ) )
+            { connect( widget, &QObject::destroyed, this, &PropertyCache::widgetDestroyed, Qt::UniqueConnection ); }
+
+            target = &_detected[widget];
+
+        }
+
+        Flags& flags( *target );
+        if( flag == MenuTitle ) flags |= MenuTitleKnown;
+        else if( flag == AlteredBackground ) flags |= AlteredBackgroundKnown;
+
+        if( value ) flags |= flag;
+        else flags &= ~Flags( flag );
+    }
+
+    //____________________________________________________________________________________
+    bool PropertyCache::eventFilter( QObject* object, QEvent* event )
+    {
+        if( event->type() != QEvent::DynamicPropertyChange ) return false;
+
+        auto iter( _flags.find( object ) );
+        if( iter != _flags.end() )
+        { update( object, static_cast<QDynamicPropertyChangeEvent*>( event )->propertyName(), iter.value() ); }
+
+        return false;
+    }
+
+    //____________________________________________________________________________________
+    void PropertyCache::widgetDestroyed( QObject* object )
+    {
+        _flags.remove( object );
+        _detected.remove( object );
+    }
+
+    //____________________________________________________________________________________
+    void PropertyCache::update( const QObject* object, const QByteArray& name, Flags& flags )
+    {
+        for( const Flag flag : { SidePanelView, NoWindowGrab, NetWMSkipShadow, NetWMForceShadow, ToolButtonAlignLeft, MenuTitle, AlteredBackground } )
+        {
+            if( name != propertyName( flag ) ) continue;
+
+            // removed properties are invalid, and reset the flag
+            update( flag, object->property( name.constData() ), flags );
+            return;
+        }
+    }
+
+    //____________________________________________________________________________________
+    void PropertyCache::update( Flag flag, const QVariant& value, Flags& flags )
+    {
+
+        const bool set( flag == ToolButtonAlignLeft ? value.toInt() == Qt::AlignLeft : value.toBool() );
+        if( set ) flags |= flag;
+        else flags &= ~Flags( flag );
+
+        // explicitly set properties override style detection
+        Flags known;
+        if( flag == MenuTitle ) known = MenuTitleKnown;
+        else if( flag == AlteredBackground ) known = AlteredBackgroundKnown;
+
+        if( value.isValid() ) flags |= known;
+        else flags &= ~known;
+
+    }
+
+    //____________________________________________________________________________________
+    const char* PropertyCache::propertyName( Flag flag )
+    {
+        switch( flag )
+        {
+            case SidePanelView: return PropertyNames::sidePanelView;
+            case NoWindowGrab: return PropertyNames::noWindowGrab;
+            case NetWMSkipShadow: return PropertyNames::netWMSkipShadow;
+            case NetWMForceShadow: return PropertyNames::netWMForceShadow;
+            case ToolButtonAlignLeft: return PropertyNames::toolButtonAlignment;
+            case MenuTitle: return PropertyNames::menuTitle;
+            case AlteredBackground: return PropertyNames::alteredBackground;
+            default: return nullptr;
+        }
+    }
+
+}
@@ -0,0 +1,122 @@
+#ifndef ferenpropertycache_h
+#define ferenpropertycache_h
+
+/*************************************************************************
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include <QFlags>
+#include <QHash>
+#include <QObject>
+#include <QVariant>
+#include <QWidget>
+
+namespace Feren
+{
+
+    //* caches style hint properties of polished widgets as bits
+    /**
+    dynamic properties are read once, then refreshed on QEvent::DynamicPropertyChange,
+    so that paint code does not search dynamic property names and construct QVariants.
+    Only menus, item views, tool buttons and top level widgets, which carry the cached properties, are registered,
+    on polish or on first access. Other widgets only have the requested properties read on access, as plain
+    property lookups, and only detected flags stored
+    */
+    class PropertyCache: public QObject
+    {
+
+        Q_OBJECT
+
+        public:
+
+        //* cached flags
+        enum Flag
+        {
+            SidePanelView = 1<<0,
+            NoWindowGrab = 1<<1,
+            NetWMSkipShadow = 1<<2,
+            NetWMForceShadow = 1<<3,
+            ToolButtonAlignLeft = 1<<4,
+            MenuTitleKnown = 1<<5,
+            MenuTitle = 1<<6,
+            AlteredBackgroundKnown = 1<<7,
+            AlteredBackground = 1<<8
+        };
+
+        Q_DECLARE_FLAGS( Flags, Flag )
+
+        //* constructor
+        explicit PropertyCache( QObject* parent ):
+            QObject( parent )
+        {}
+
+        //* register widget
+        void registerWidget( QWidget* );
+
+        //* unregister widget
+        void unregisterWidget( QWidget* );
+
+        //* true if widget is registered
+        bool isRegistered( const QWidget* widget ) const
+        { return _flags.contains( widget ); }
+
+        //* true if widget is of a type whose properties are cached
+        static bool isWatched( const QWidget* );
+
+        //* flags for a given widget, registering it if needed
+        /** for widgets that are not watched, only the requested properties are read */
+        Flags flags( const QWidget*, Flags properties );
+
+        //* true if flag is set for a given widget
+        bool testFlag( const QWidget* widget, Flag flag )
+        { return widget && flags( widget, flag ).testFlag( flag ); }
+
+        //* store a computed flag
+        /** used for menu titles and altered backgrounds, which are detected by the style unless set explicitly */
+        void setFlag( const QWidget*, Flag, bool );
+
+        //* event filter
+        bool eventFilter( QObject*, QEvent* ) override;
+
+        protected Q_SLOTS:
+
+        //* triggered by object destruction
+        void widgetDestroyed( QObject* );
+
+        private:
+
+        //* update flags from a given property
+        static void update( const QObject*, const QByteArray&, Flags& );
+
+        //* update flags from a given property value
+        static void update( Flag, const QVariant&, Flags& );
+
+        //* property name matching a given flag
+        static const char* propertyName( Flag );
+
+        //* flags, for registered widgets
+        QHash<const QObject*, Flags> _flags;
+
+        //* flags detected by the style, for widgets that are not registered
+        QHash<const QObject*, Flags> _detected;
+
+    };
+
+}
+
+Q_DECLARE_OPERATORS_FOR_FLAGS( Feren::PropertyCache::Flags )
+
+#endif
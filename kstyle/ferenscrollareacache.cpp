@@ -0,0 +1,176 @@
+/*************************************************************************
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include "ferenscrollareacache.h"
+
+#include <QAbstractScrollArea>
+
+namespace Feren
+{
+
+    //____________________________________________________________________________________
+    void ScrollAreaCache::registerWidget( QWidget* widget )
+    {
+
+        if( !widget ) return;
+        if( isRegistered( widget ) ) return;
+
+        // resolve children right away
+        Entry& entry( _entries[widget] );
+        resolve( widget, entry );
+
+        // catch object destruction
+        connect( widget, &QObject::destroyed, this, &ScrollAreaCache::widgetDestroyed, Qt::UniqueConnection );
+
+    }
+
+    //____________________________________________________________________________________
+    void ScrollAreaCache::unregisterWidget( QWidget* widget )
+    {
+        if( !widget ) return;
+
+        auto iter( _entries.find( widget ) );
+        if( iter == _entries.end() ) return;
+
+        unwatch( widget, *iter );
+        _entries.erase( iter );
+        disconnect( widget, &QObject::destroyed, this, &ScrollAreaCache::widgetDestroyed );
+    }
+
+    //____________________________________________________________________________________
+    void ScrollAreaCache::invalidate( const QWidget* widget )
+    {
+        auto iter( _entries.find( widget ) );
+        if( iter != _entries.end() ) iter->valid = false;
+    }
+
+    //____________________________________________________________________________________
+    QList<QWidget*> ScrollAreaCache::containers( const QWidget* widget )
+    {
+        QList<QWidget*> out;
+        if( Entry* entry = this->entry( widget ) )
+        {
+            for( const auto& container : entry->containers )
+            { if( container ) out.append( container.data() ); }
+        }
+
+        return out;
+    }
+
+    //____________________________________________________________________________________
+    QList<QScrollBar*> ScrollAreaCache::scrollBars( const QWidget* widget )
+    {
+        QList<QScrollBar*> out;
+        Entry* entry = this->entry( widget );
+        if( !entry ) return out;
+
+        // an empty list is kept as well. Scrollbars added later invalidate the entry through ChildAdded
+        for( const auto& scrollBar : entry->scrollBars )
+        { if( scrollBar ) out.append( scrollBar.data() ); }
+
+        return out;
+    }
+
+    //____________________________________________________________________________________
+    bool ScrollAreaCache::eventFilter( QObject* object, QEvent* event )
+    {
+        switch( event->type() )
+        {
+            case QEvent::ChildAdded:
+            case QEvent::ChildRemoved:
+            if( const QWidget* owner = _owners.value( object ) ) invalidate( owner );
+            break;
+
+            default: break;
+        }
+
+        return false;
+    }
+
+    //____________________________________________________________________________________
+    void ScrollAreaCache::widgetDestroyed( QObject* object )
+    {
+        auto iter( _entries.find( object ) );
+        if( iter == _entries.end() ) return;
+
+        unwatch( object, *iter );
+        _entries.erase( iter );
+    }
+
+    //____________________________________________________________________________________
+    void ScrollAreaCache::unwatch( const QObject* owner, Entry& entry )
+    {
+        for( const auto& watched : entry.watched )
+        { if( watched ) watched->removeEventFilter( this ); }
+
+        entry.watched.clear();
+
+        // also drop widgets that were deleted in the meantime
+        for( auto iter = _owners.begin(); iter != _owners.end(); )
+        {
+            if( iter.value() == owner ) iter = _owners.erase( iter );
+            else ++iter;
+        }
+    }
+
+    //____________________________________________________________________________________
+    ScrollAreaCache::Entry* ScrollAreaCache::entry( const QWidget* widget )
+    {
+        auto iter( _entries.find( widget ) );
+        if( iter == _entries.end() ) return nullptr;
+        if( !iter->valid ) resolve( widget, *iter );
+        return &iter.value();
+    }
+
+    //____________________________________________________________________________________
+    void ScrollAreaCache::resolve( const QWidget* widget, Entry& entry )
+    {
+
+        unwatch( widget, entry );
+        entry.containers.clear();
+        entry.scrollBars.clear();
+        entry.valid = true;
+
+        if( auto scrollArea = qobject_cast<const QAbstractScrollArea*>( widget ) )
+        {
+
+            // scrollbar containers are direct children of the scroll area
+            if( auto child = scrollArea->findChild<QWidget*>( QStringLiteral( "qt_scrollarea_vcontainer" ), Qt::FindDirectChildrenOnly ) )
+            { entry.containers.append( child ); }
+
+            if( auto child = scrollArea->findChild<QWidget*>( QStringLiteral( "qt_scrollarea_hcontainer" ), Qt::FindDirectChildrenOnly ) )
+            { entry.containers.append( child ); }
+
+        } else {
+
+            // KTextEditor::View manages its own scrollbars, which are created below the view's children.
+            // Watch every other widget below the view, so that scrollbars added later invalidate the cache
+            for( auto child : widget->findChildren<QWidget*>() )
+            {
+                if( auto scrollBar = qobject_cast<QScrollBar*>( child ) ) entry.scrollBars.append( scrollBar );
+                else {
+                    child->installEventFilter( this );
+                    _owners.insert( child, widget );
+                    entry.watched.append( child );
+                }
+            }
+
+        }
+
+    }
+
+}
@@ -0,0 +1,118 @@
+#ifndef ferenscrollareacache_h
+#define ferenscrollareacache_h
+
+/*************************************************************************
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QScrollBar>
+#include <QWidget>
+
+namespace Feren
+{
+
+    //* caches scrollbar containers and scrollbars of polished scroll areas
+    /**
+    this avoids walking the object tree on every paint and mouse event.
+    Cached children are resolved again on next access after the scroll area's children have changed.
+    For KTextEditor::View, scrollbars are not direct children, so all widgets below the view are watched as well
+    */
+    class ScrollAreaCache: public QObject
+    {
+
+        Q_OBJECT
+
+        public:
+
+        //* constructor
+        explicit ScrollAreaCache( QObject* parent ):
+            QObject( parent )
+        {}
+
+        //* register scroll area, or KTextEditor::View
+        void registerWidget( QWidget* );
+
+        //* unregister
+        void unregisterWidget( QWidget* );
+
+        //* true if widget is registered
+        bool isRegistered( const QWidget* widget ) const
+        { return _entries.contains( widget ); }
+
+        //* mark cached children as outdated
+        /** to be called when children are added or removed */
+        void invalidate( const QWidget* );
+
+        //* scrollbar containers
+        QList<QWidget*> containers( const QWidget* );
+
+        //* scrollbars
+        /** only used for KTextEditor::View. Scroll areas provide direct access to theirs */
+        QList<QScrollBar*> scrollBars( const QWidget* );
+
+        //* event filter, to catch children changes below KTextEditor::View
+        bool eventFilter( QObject*, QEvent* ) override;
+
+        protected Q_SLOTS:
+
+        //* triggered by object destruction
+        void widgetDestroyed( QObject* );
+
+        private:
+
+        //* cached children
+        class Entry
+        {
+            public:
+
+            //* containers
+            QList<QPointer<QWidget>> containers;
+
+            //* scrollbars
+            QList<QPointer<QScrollBar>> scrollBars;
+
+            //* widgets watched for children changes
+            QList<QPointer<QWidget>> watched;
+
+            //* true if children are up to date
+            bool valid = false;
+
+        };
+
+        //* find entry and make sure it is up to date
+        Entry* entry( const QWidget* );
+
+        //* resolve children
+        void resolve( const QWidget*, Entry& );
+
+        //* stop watching widgets below a given widget
+        void unwatch( const QObject*, Entry& );
+
+        //* entries
+        QHash<const QObject*, Entry> _entries;
+
+        //* watched widgets, and the widget they belong to
+        QHash<const QObject*, const QWidget*> _owners;
+
+    };
+
+}
+
+#endif
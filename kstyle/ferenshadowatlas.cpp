@@ -0,0 +1,289 @@
+/*************************************************************************
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include "ferenshadowatlas.h"
+
+#include "feren.h"
+#include "ferenboxshadowrenderer.h"
+#include "ferenhelper.h"
+#include "ferenshadowhelper.h"
+#include "ferentracerecorder.h"
+#include "ferenconfigdata.h"
+
+#include <QApplication>
+#include <QPainter>
+
+#include <algorithm>
+
+namespace Feren
+{
+
+    //* number of unused, non persistent entries kept
+    static const int MaxUnusedEntries = 2;
+
+    //_____________________________________________________
+    ShadowAtlas::ShadowAtlas( Helper& helper ):
+        _helper( helper )
+    {
+        _registryId = _helper.cacheRegistry().registerCache( QStringLiteral( "ShadowAtlas" ),
+            [this]() { return cost(); },
+            [this]() { purgeUnused(); return cost(); },
+            [this]() { return reclaimableCost(); } );
+    }
+
+    //_____________________________________________________
+    ShadowAtlas::~ShadowAtlas()
+    { _helper.cacheRegistry().unregisterCache( _registryId ); }
+
+    //_____________________________________________________
+    TileSet ShadowAtlas::acquire( qreal devicePixelRatio )
+    {
+        Entry& entry( this->entry( devicePixelRatio ) );
+        ++entry.refCount;
+        return entry.tileSet;
+    }
+
+    //_____________________________________________________
+    void ShadowAtlas::release( qreal devicePixelRatio )
+    {
+        auto iter( _entries.find( devicePixelRatio ) );
+        if( iter == _entries.end() ) return;
+
+        if( iter->refCount > 0 ) --iter->refCount;
+        if( iter->refCount == 0 ) evictUnused();
+    }
+
+    //_____________________________________________________
+    void ShadowAtlas::evictUnused()
+    {
+        QList<QMap<qreal, Entry>::iterator> unused;
+        for( auto iter = _entries.begin(); iter != _entries.end(); ++iter )
+        { if( iter->refCount == 0 && !isPersistent( iter.key() ) ) unused.append( iter ); }
+
+        if( unused.size() <= MaxUnusedEntries ) return;
+
+        std::sort( unused.begin(), unused.end(),
+            []( const QMap<qreal, Entry>::iterator& first, const QMap<qreal, Entry>::iterator& second )
+            { return first->lastUse < second->lastUse; } );
+
+        for( int index = 0; index < unused.size() - MaxUnusedEntries; ++index )
+        { _entries.erase( unused[index] ); }
+
+        _helper.cacheRegistry().removed( _registryId, cost() );
+    }
+
+    //_____________________________________________________
+    TileSet ShadowAtlas::tileSet( qreal devicePixelRatio )
+    { return entry( devicePixelRatio ).tileSet; }
+
+    //_____________________________________________________
+    const QVector<KWindowShadowTile::Ptr>& ShadowAtlas::platformTiles( qreal devicePixelRatio )
+    {
+        Entry& entry( this->entry( devicePixelRatio ) );
+        if( entry.platformTiles.isEmpty() && entry.tileSet.isValid() )
+        {
+            const TileSet& tileSet( entry.tileSet );
+            entry.platformTiles = {
+                createTile( tileSet.pixmap( 1 ) ),
+                createTile( tileSet.pixmap( 2 ) ),
+                createTile( tileSet.pixmap( 5 ) ),
+                createTile( tileSet.pixmap( 8 ) ),
+                createTile( tileSet.pixmap( 7 ) ),
+                createTile( tileSet.pixmap( 6 ) ),
+                createTile( tileSet.pixmap( 3 ) ),
+                createTile( tileSet.pixmap( 0 ) )
+            };
+        }
+
+        return entry.platformTiles;
+    }
+
+    //_____________________________________________________
+    void ShadowAtlas::invalidate()
+    {
+        for( auto iter = _entries.begin(); iter != _entries.end(); )
+        {
+            if( iter->refCount == 0 ) iter = _entries.erase( iter );
+            else {
+                iter->tileSet = TileSet();
+                iter->platformTiles.clear();
+                ++iter;
+            }
+        }
+
+        _helper.cacheRegistry().removed( _registryId, 0 );
+    }
+
+    //_____________________________________________________
+    void ShadowAtlas::purgeUnused()
+    {
+        for( auto iter = _entries.begin(); iter != _entries.end(); )
+        {
+            if( iter->refCount == 0 ) iter = _entries.erase( iter );
+            else ++iter;
+        }
+    }
+
+    //_____________________________________________________
+    int ShadowAtlas::count() const
+    {
+        int count = 0;
+        for( const Entry& entry : _entries )
+        { if( entry.tileSet.isValid() ) ++count; }
+        return count;
+    }
+
+    //_____________________________________________________
+    qint64 ShadowAtlas::cost() const
+    {
+        qint64 cost = 0;
+        for( const Entry& entry : _entries )
+        { cost += entryCost( entry ); }
+
+        return cost;
+    }
+
+    //_____________________________________________________
+    qint64 ShadowAtlas::reclaimableCost() const
+    {
+        qint64 cost = 0;
+        for( const Entry& entry : _entries )
+        { if( entry.refCount == 0 ) cost += entryCost( entry ); }
+
+        return cost;
+    }
+
+    //_____________________________________________________
+    qint64 ShadowAtlas::entryCost( const Entry& entry )
+    {
+        if( !entry.tileSet.isValid() ) return 0;
+
+        qint64 cost = 0;
+        for( int index = 0; index < 9; ++index )
+        {
+            const QPixmap pixmap( entry.tileSet.pixmap( index ) );
+            cost += qint64( pixmap.width() )*pixmap.height()*pixmap.depth()/8;
+        }
+
+        return cost;
+    }
+
+    //_____________________________________________________
+    ShadowAtlas::Entry& ShadowAtlas::entry( qreal devicePixelRatio )
+    {
+        CacheRegistry& registry( _helper.cacheRegistry() );
+        Entry& entry( _entries[devicePixelRatio] );
+        entry.lastUse = ++_useCounter;
+        if( entry.tileSet.isValid() ) registry.hit( _registryId );
+        else {
+
+            registry.miss( _registryId );
+            entry.tileSet = render( devicePixelRatio );
+            entry.platformTiles.clear();
+            registry.inserted( _registryId, cost() );
+
+        }
+
+        return entry;
+    }
+
+    //_____________________________________________________
+    TileSet ShadowAtlas::render( qreal dpr ) const
+    {
+        const TraceRecorder::Span traceSpan( "shadow", "ShadowAtlas::render" );
+
+        const CompositeShadowParams params = ShadowHelper::lookupShadowParams( StyleConfigData::shadowSize() );
+        if( params.isNone() ) return TileSet();
+
+        auto withOpacity = [](const QColor &color, qreal opacity) -> QColor {
+            QColor c(color);
+            c.setAlphaF(opacity);
+            return c;
+        };
+
+        const QColor color = StyleConfigData::shadowColor();
+        const qreal strength = static_cast<qreal>(StyleConfigData::shadowStrength()) / 255.0;
+
+        const QSize boxSize = BoxShadowRenderer::calculateMinimumBoxSize(params.shadow1.radius)
+            .expandedTo(BoxShadowRenderer::calculateMinimumBoxSize(params.shadow2.radius));
+
+        const qreal frameRadius = _helper.frameRadius();
+
+        BoxShadowRenderer shadowRenderer;
+        shadowRenderer.setBorderRadius(frameRadius);
+        shadowRenderer.setBoxSize(boxSize);
+        shadowRenderer.setDevicePixelRatio(dpr);
+        shadowRenderer.setBlurMethod(StyleConfigData::shadowBlur() == StyleConfigData::ShadowBlurGaussian
+            ? BoxShadowRenderer::BlurMethod::GaussianBlur
+            : BoxShadowRenderer::BlurMethod::BoxBlur);
+
+        shadowRenderer.addShadow(params.shadow1.offset, params.shadow1.radius,
+            withOpacity(color, params.shadow1.opacity * strength));
+        shadowRenderer.addShadow(params.shadow2.offset, params.shadow2.radius,
+            withOpacity(color, params.shadow2.opacity * strength));
+
+        QImage shadowTexture = shadowRenderer.render();
+
+        const QRect outerRect(QPoint(0, 0), shadowTexture.size() / dpr);
+
+        QRect boxRect(QPoint(0, 0), boxSize);
+        boxRect.moveCenter(outerRect.center());
+
+        // Mask out inner rect.
+        QPainter painter(&shadowTexture);
+        painter.setRenderHint(QPainter::Antialiasing);
+
+        const QMargins margins = QMargins(
+            boxRect.left() - outerRect.left() - Metrics::Shadow_Overlap - params.offset.x(),
+            boxRect.top() - outerRect.top() - Metrics::Shadow_Overlap - params.offset.y(),
+            outerRect.right() - boxRect.right() - Metrics::Shadow_Overlap + params.offset.x(),
+            outerRect.bottom() - boxRect.bottom() - Metrics::Shadow_Overlap + params.offset.y());
+
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(Qt::black);
+        painter.setCompositionMode(QPainter::CompositionMode_DestinationOut);
+        painter.drawRoundedRect(
+            outerRect - margins,
+            frameRadius,
+            frameRadius);
+
+        // We're done.
+        painter.end();
+
+        const QPoint innerRectTopLeft = outerRect.center();
+        return TileSet(
+            QPixmap::fromImage(shadowTexture),
+            innerRectTopLeft.x(),
+            innerRectTopLeft.y(),
+            1, 1);
+    }
+
+    //______________________________________________
+    KWindowShadowTile::Ptr ShadowAtlas::createTile( const QPixmap& source )
+    {
+
+        KWindowShadowTile::Ptr tile = KWindowShadowTile::Ptr::create();
+        tile->setImage( source.toImage() );
+        return tile;
+
+    }
+
+    //______________________________________________
+    bool ShadowAtlas::isPersistent( qreal devicePixelRatio )
+    { return qFuzzyCompare( devicePixelRatio, qApp->devicePixelRatio() ); }
+
+}
@@ -0,0 +1,144 @@
+#ifndef ferenshadowatlas_h
+#define ferenshadowatlas_h
+
+/*************************************************************************
+ * This program is free software; you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation; either version 2 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program; if not, write to the                         *
+ * Free Software Foundation, Inc.,                                       *
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
+ *************************************************************************/
+
+#include "ferentileset.h"
+
+#include <KWindowShadow>
+
+#include <QMap>
+#include <QVector>
+
+namespace Feren
+{
+
+    //* forward declaration
+    class Helper;
+
+    //* process-wide store of rendered shadow textures
+    /**
+    one texture is rendered per device pixel ratio for the current shadow parameters,
+    and shared between top-level window shadows, mdi sub-window shadows and any other in-process shadow.
+    Textures are reference counted. Variants that are no longer used are kept for a while, so that moving
+    a window back and forth between screens does not render them again, and only the least recently used
+    ones are evicted. The application's own device pixel ratio is never evicted.
+    */
+    class ShadowAtlas
+    {
+
+        public:
+
+        //* constructor
+        explicit ShadowAtlas( Helper& );
+
+        //* destructor
+        ~ShadowAtlas();
+
+        //* number of platform tiles
+        enum { numTiles = 8 };
+
+        //* acquire shadow for given device pixel ratio and return matching tileset
+        /** this increments the reference count. It must be balanced by a call to release */
+        TileSet acquire( qreal devicePixelRatio );
+
+        //* release shadow for given device pixel ratio
+        /** when its reference count drops to zero, the entry is kept among recently used ones */
+        void release( qreal devicePixelRatio );
+
+        //* tileset for given device pixel ratio
+        /** rendered on demand. The reference count is left unchanged */
+        TileSet tileSet( qreal devicePixelRatio );
+
+        //* platform tiles for given device pixel ratio, shared by all windows with this ratio
+        const QVector<KWindowShadowTile::Ptr>& platformTiles( qreal devicePixelRatio );
+
+        //* drop all rendered textures
+        /** reference counts are kept, so that textures get rendered again on next access */
+        void invalidate();
+
+        //* drop textures that are not used by any window
+        /** textures in use are kept, since windows would otherwise render their own copy again */
+        void purgeUnused();
+
+        //* number of textures currently held
+        int count() const;
+
+        //* memory held by textures, in bytes
+        qint64 cost() const;
+
+        //* memory held by textures not used by any window, in bytes
+        /** this is what purgeUnused can reclaim */
+        qint64 reclaimableCost() const;
+
+        private:
+
+        //* atlas entry
+        class Entry
+        {
+            public:
+
+            //* tileset
+            TileSet tileSet;
+
+            //* platform tiles, created on demand
+            QVector<KWindowShadowTile::Ptr> platformTiles;
+
+            //* number of users
+            int refCount = 0;
+
+            //* last use, for eviction of unused entries
+            quint64 lastUse = 0;
+
+        };
+
+        //* memory held by an entry's texture, in bytes
+        static qint64 entryCost( const Entry& );
+
+        //* find or create entry for a given device pixel ratio, making sure the texture is rendered
+        Entry& entry( qreal devicePixelRatio );
+
+        //* render shadow texture for a given device pixel ratio
+        TileSet render( qreal devicePixelRatio ) const;
+
+        //* create platform tile from pixmap
+        static KWindowShadowTile::Ptr createTile( const QPixmap& );
+
+        //* true if entry must be kept even when unused
+        static bool isPersistent( qreal devicePixelRatio );
+
+        //* evict least recently used entries that are neither used nor persistent, above the allowed number
+        void evictUnused();
+
+        //* helper
+        Helper& _helper;
+
+        //* entries, keyed by device pixel ratio
+        QMap<qreal, Entry> _entries;
+
+        //* id in helper's cache registry
+        int _registryId = -1;
+
+        //* use counter
+        quint64 _useCounter = 0;
+
+    };
+
+}
+
+#endif
@@ -23,6 +23,7 @@
 #include "feren.h"
 #include "ferenboxshadowrenderer.h"
 #include "ferenhelper.h"
+#include "ferenpropertycache.h"
 #include "ferenpropertynames.h"
 #include "ferenconfigdata.h"
 
@@ -30,10 +31,10 @@
 #include <QEvent>
 #include <QApplication>
 #include <QMenu>
-#include <QPainter>
 #include <QPixmap>
 #include <QPlatformSurfaceEvent>
 #include <QToolBar>
+#include <QWindow>
 #include <QTextStream>
 
 namespace
@@ -95,7 +96,8 @@ namespace Feren
     //_____________________________________________________
     ShadowHelper::ShadowHelper( QObject* parent, Helper& helper ):
         QObject( parent ),
-        _helper( helper )
+        _helper( helper ),
+        _atlas( helper )
     {
     }
 
@@ -107,11 +109,7 @@ namespace Feren
 
     //______________________________________________
     void ShadowHelper::reset()
-    {
-        _tiles.clear();
-        _shadowTiles = TileSet();
-
-    }
+    { _atlas.invalidate(); }
 
     //_______________________________________________________
     bool ShadowHelper::registerWidget( QWidget* widget, bool force )
@@ -123,9 +121,9 @@ namespace Feren
         if( !( force || acceptWidget( widget ) ) )
         { return false; }
 
-        // try create shadow directly
-        installShadows( widget );
+        // try create shadow
         _widgets.insert( widget );
+        scheduleShadows( widget );
 
         // install event filter
         widget->removeEventFilter( this );
@@ -150,6 +148,7 @@ namespace Feren
             disconnect( widget, nullptr, this, nullptr );
 
             // uninstall the shadow
+            _pendingWidgets.removeAll( widget );
             uninstallShadows( widget );
         }
     }
@@ -163,7 +162,7 @@ namespace Feren
 
         // update property for registered widgets
         for( QWidget* widget : _widgets)
-        { installShadows( widget ); }
+        { scheduleShadows( widget ); }
 
     }
 
@@ -179,7 +178,7 @@ namespace Feren
             QWidget* widget( static_cast<QWidget*>( object ) );
 
             // install shadows and update winId
-            installShadows( widget );
+            scheduleShadows( widget );
 
         } else {
             if( event->type() != QEvent::PlatformSurface ) return false;
@@ -190,7 +189,7 @@ namespace Feren
             switch( surfaceEvent->surfaceEventType() )
             {
                 case QPlatformSurfaceEvent::SurfaceCreated:
-                    installShadows( widget );
+                    scheduleShadows( widget );
                     break;
                 case QPlatformSurfaceEvent::SurfaceAboutToBeDestroyed:
                     // Don't care.
@@ -203,86 +202,25 @@ namespace Feren
     }
 
     //_______________________________________________________
-    TileSet ShadowHelper::shadowTiles()
+    void ShadowHelper::timerEvent( QTimerEvent* event )
     {
-        const CompositeShadowParams params = lookupShadowParams(StyleConfigData::shadowSize());
-
-        if (params.isNone()) {
-            return TileSet();
-        } else if (_shadowTiles.isValid()) {
-            return _shadowTiles;
-        }
-
-        auto withOpacity = [](const QColor &color, qreal opacity) -> QColor {
-            QColor c(color);
-            c.setAlphaF(opacity);
-            return c;
-        };
-
-        const QColor color = StyleConfigData::shadowColor();
-        const qreal strength = static_cast<qreal>(StyleConfigData::shadowStrength()) / 255.0;
-
-        const QSize boxSize = BoxShadowRenderer::calculateMinimumBoxSize(params.shadow1.radius)
-            .expandedTo(BoxShadowRenderer::calculateMinimumBoxSize(params.shadow2.radius));
-
-        const qreal dpr = qApp->devicePixelRatio();
-        const qreal frameRadius = _helper.frameRadius();
-
-        BoxShadowRenderer shadowRenderer;
-        shadowRenderer.setBorderRadius(frameRadius);
-        shadowRenderer.setBoxSize(boxSize);
-        shadowRenderer.setDevicePixelRatio(dpr);
-
-        shadowRenderer.addShadow(params.shadow1.offset, params.shadow1.radius,
-            withOpacity(color, params.shadow1.opacity * strength));
-        shadowRenderer.addShadow(params.shadow2.offset, params.shadow2.radius,
-            withOpacity(color, params.shadow2.opacity * strength));
-
-        QImage shadowTexture = shadowRenderer.render();
+        if( event->timerId() == _flushTimer.timerId() )
+        {
 
-        const QRect outerRect(QPoint(0, 0), shadowTexture.size() / dpr);
+            _flushTimer.stop();
+            flushShadows();
 
-        QRect boxRect(QPoint(0, 0), boxSize);
-        boxRect.moveCenter(outerRect.center());
-
-        // Mask out inner rect.
-        QPainter painter(&shadowTexture);
-        painter.setRenderHint(QPainter::Antialiasing);
-
-        const QMargins margins = QMargins(
-            boxRect.left() - outerRect.left() - Metrics::Shadow_Overlap - params.offset.x(),
-            boxRect.top() - outerRect.top() - Metrics::Shadow_Overlap - params.offset.y(),
-            outerRect.right() - boxRect.right() - Metrics::Shadow_Overlap + params.offset.x(),
-            outerRect.bottom() - boxRect.bottom() - Metrics::Shadow_Overlap + params.offset.y());
-
-        painter.setPen(Qt::NoPen);
-        painter.setBrush(Qt::black);
-        painter.setCompositionMode(QPainter::CompositionMode_DestinationOut);
-        painter.drawRoundedRect(
-            outerRect - margins,
-            frameRadius,
-            frameRadius);
-
-        // We're done.
-        painter.end();
-
-        const QPoint innerRectTopLeft = outerRect.center();
-        _shadowTiles = TileSet(
-            QPixmap::fromImage(shadowTexture),
-            innerRectTopLeft.x(),
-            innerRectTopLeft.y(),
-            1, 1);
-
-        return _shadowTiles;
+        } else return QObject::timerEvent( event );
     }
 
-
     //_______________________________________________________
     void ShadowHelper::objectDeleted( QObject* object )
     {
         QWidget* widget( static_cast<QWidget*>( object ) );
         _widgets.remove( widget );
         _shadows.remove( widget );
+        _pendingWidgets.removeAll( widget );
+        releaseShadowTiles( widget );
 
     }
 
@@ -307,8 +245,19 @@ namespace Feren
     {
 
         // flags
-        if( widget->property( PropertyNames::netWMSkipShadow ).toBool() ) return false;
-        if( widget->property( PropertyNames::netWMForceShadow ).toBool() ) return true;
+        if( _propertyCache )
+        {
+
+            const PropertyCache::Flags flags( _propertyCache->flags( widget, PropertyCache::NetWMSkipShadow|PropertyCache::NetWMForceShadow ) );
+            if( flags.testFlag( PropertyCache::NetWMSkipShadow ) ) return false;
+            if( flags.testFlag( PropertyCache::NetWMForceShadow ) ) return true;
+
+        } else {
+
+            if( widget->property( PropertyNames::netWMSkipShadow ).toBool() ) return false;
+            if( widget->property( PropertyNames::netWMForceShadow ).toBool() ) return true;
+
+        }
 
         // stop giving menus shadows (match with GTK theme)
         if( isMenu( widget ) ) return false;
@@ -328,58 +277,51 @@ namespace Feren
         return false;
     }
 
-    //______________________________________________
-    const QVector<KWindowShadowTile::Ptr>& ShadowHelper::createShadowTiles()
+    //_______________________________________________________
+    void ShadowHelper::scheduleShadows( QWidget* widget )
     {
-
-        // make sure size is valid
-        if( _tiles.isEmpty() )
-        {
-            _tiles = {
-                createTile( _shadowTiles.pixmap( 1 ) ),
-                createTile( _shadowTiles.pixmap( 2 ) ),
-                createTile( _shadowTiles.pixmap( 5 ) ),
-                createTile( _shadowTiles.pixmap( 8 ) ),
-                createTile( _shadowTiles.pixmap( 7 ) ),
-                createTile( _shadowTiles.pixmap( 6 ) ),
-                createTile( _shadowTiles.pixmap( 3 ) ),
-                createTile( _shadowTiles.pixmap( 0 ) )
-            };
-        }
-
-        // return relevant list of shadow tiles
-        return _tiles;
-
+        /*
+        menus, tooltips and completion popups are often created in bursts,
+        within a single event loop iteration. Queue them, so that each window
+        is handled once, with shared tiles, when the iteration completes
+        */
+        if( !_pendingWidgets.contains( widget ) ) _pendingWidgets.append( widget );
+        if( !_flushTimer.isActive() ) _flushTimer.start( 0, this );
     }
 
-    //______________________________________________
-    KWindowShadowTile::Ptr ShadowHelper::createTile( const QPixmap& source )
+    //_______________________________________________________
+    void ShadowHelper::flushShadows()
     {
+        const QList<QWidget*> widgets( _pendingWidgets );
+        _pendingWidgets.clear();
 
-        KWindowShadowTile::Ptr tile = KWindowShadowTile::Ptr::create();
-        tile->setImage( source.toImage() );
-        return tile;
+        // only count windows that actually got shadows installed
+        int count = 0;
+        for( QWidget* widget : widgets )
+        { if( installShadows( widget ) ) ++count; }
 
+        _lastFlushWindowCount = count;
+        _maxFlushWindowCount = qMax( _maxFlushWindowCount, _lastFlushWindowCount );
     }
 
     //_______________________________________________________
-    void ShadowHelper::installShadows( QWidget* widget )
+    bool ShadowHelper::installShadows( QWidget* widget )
     {
-        if( !widget ) return;
+        if( !widget ) return false;
 
         // only toplevel widgets can cast drop-shadows
-        if( !widget->isWindow() ) return;
+        if( !widget->isWindow() ) return false;
 
         // widget must have valid native window
-        if( !widget->testAttribute( Qt::WA_WState_Created ) ) return;
+        if( !widget->testAttribute( Qt::WA_WState_Created ) ) return false;
 
-        // create shadow tiles if needed
-        shadowTiles();
-        if( !_shadowTiles.isValid() ) return;
+        // get shared shadow tiles matching the screen the window is on, rendered if needed
+        const qreal devicePixelRatio( widget->devicePixelRatioF() );
+        const QVector<KWindowShadowTile::Ptr>& tiles = _atlas.platformTiles( devicePixelRatio );
+        if( tiles.count() != ShadowAtlas::numTiles ) return false;
 
-        // create platform shadow tiles if needed
-        const QVector<KWindowShadowTile::Ptr>& tiles = createShadowTiles();
-        if( tiles.count() != numTiles ) return;
+        // hold a reference on the atlas entry while the shadow is installed
+        acquireShadowTiles( widget, devicePixelRatio );
 
         // find a shadow associated with the widget
         KWindowShadow*& shadow = _shadows[ widget ];
@@ -398,13 +340,36 @@ namespace Feren
         shadow->setBottomLeftTile( tiles[ 5 ] );
         shadow->setLeftTile( tiles[ 6 ] );
         shadow->setTopLeftTile( tiles[ 7 ] );
-        shadow->setPadding( shadowMargins( widget ) );
+        shadow->setPadding( shadowMargins( widget, devicePixelRatio ) );
         shadow->setWindow( widget->windowHandle() );
         shadow->create();
+
+        // track screen changes
+        connect( widget->windowHandle(), &QWindow::screenChanged, this, &ShadowHelper::windowScreenChanged, Qt::UniqueConnection );
+        return true;
+    }
+
+    //_______________________________________________________
+    void ShadowHelper::windowScreenChanged()
+    {
+        auto window( qobject_cast<QWindow*>( sender() ) );
+        if( !window ) return;
+
+        for( QWidget* widget : _widgets )
+        {
+            if( widget->windowHandle() != window ) continue;
+
+            // re-install only if the device pixel ratio actually changed.
+            // Tiles for the new ratio are reused from the atlas when already rendered
+            if( _devicePixelRatios.value( widget ) != widget->devicePixelRatioF() )
+            { installShadows( widget ); }
+
+            break;
+        }
     }
 
     //_______________________________________________________
-    QMargins ShadowHelper::shadowMargins( QWidget* widget ) const
+    QMargins ShadowHelper::shadowMargins( QWidget* widget, qreal devicePixelRatio ) const
     {
         const CompositeShadowParams params = lookupShadowParams(StyleConfigData::shadowSize());
         if (params.isNone()) {
@@ -445,7 +410,7 @@ namespace Feren
             }
         }
 
-        margins *= _helper.devicePixelRatio(_shadowTiles.pixmap(0));
+        margins *= devicePixelRatio;
 
         return margins;
     }
@@ -454,6 +419,36 @@ namespace Feren
     void ShadowHelper::uninstallShadows( QWidget* widget )
     {
         delete _shadows.take( widget );
+        releaseShadowTiles( widget );
+    }
+
+    //_______________________________________________________
+    void ShadowHelper::acquireShadowTiles( QWidget* widget, qreal devicePixelRatio )
+    {
+        const auto iter( _devicePixelRatios.find( widget ) );
+        if( iter == _devicePixelRatios.end() )
+        {
+            _atlas.acquire( devicePixelRatio );
+            _devicePixelRatios.insert( widget, devicePixelRatio );
+
+        } else if( iter.value() != devicePixelRatio ) {
+
+            // acquire new variant first, so that previous one is evicted only if no other window uses it
+            _atlas.acquire( devicePixelRatio );
+            _atlas.release( iter.value() );
+            iter.value() = devicePixelRatio;
+
+        }
+    }
+
+    //_______________________________________________________
+    void ShadowHelper::releaseShadowTiles( QWidget* widget )
+    {
+        const auto iter( _devicePixelRatios.find( widget ) );
+        if( iter == _devicePixelRatios.end() ) return;
+
+        _atlas.release( iter.value() );
+        _devicePixelRatios.erase( iter );
     }
 
 }
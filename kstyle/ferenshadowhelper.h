@@ -21,10 +21,13 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA .        *
  *************************************************************************/
 
+#include "ferenshadowatlas.h"
 #include "ferentileset.h"
 
 #include <KWindowShadow>
 
+#include <QBasicTimer>
+#include <QList>
 #include <QObject>
 #include <QPointer>
 #include <QMap>
@@ -36,6 +39,7 @@ namespace Feren
 
     //* forward declaration
     class Helper;
+    class PropertyCache;
 
     struct ShadowParams
     {
@@ -104,17 +108,36 @@ namespace Feren
         //* event filter
         bool eventFilter( QObject*, QEvent* ) override;
 
-        //* shadow tiles
+        //* number of windows that got shadows installed by the last batched installation
+        int lastFlushWindowCount() const
+        { return _lastFlushWindowCount; }
+
+        //* largest number of windows that got shadows installed by a single batched installation
+        int maxFlushWindowCount() const
+        { return _maxFlushWindowCount; }
+
+        //* property cache, used to check shadow properties
+        void setPropertyCache( PropertyCache* cache )
+        { _propertyCache = cache; }
+
+        //* shadow atlas
         /** is public because it is also needed for mdi windows */
-        TileSet shadowTiles();
+        ShadowAtlas& shadowAtlas()
+        { return _atlas; }
 
         protected Q_SLOTS:
 
         //* unregister widget
         void objectDeleted( QObject* );
 
+        //* update shadow tiles when a window moves to another screen
+        void windowScreenChanged();
+
         protected:
 
+        //* timer event
+        void timerEvent( QTimerEvent* ) override;
+
         //* true if widget is a menu
         bool isMenu( QWidget* ) const;
 
@@ -130,40 +153,59 @@ namespace Feren
         //* accept widget
         bool acceptWidget( QWidget* ) const;
 
-        // create shared shadow tiles from tileset
-        const QVector<KWindowShadowTile::Ptr>& createShadowTiles();
+        //* queue shadow installation for given widget, until the end of the current event loop iteration
+        void scheduleShadows( QWidget* );
 
-        // create shadow tile from pixmap
-        KWindowShadowTile::Ptr createTile( const QPixmap& );
+        //* install shadows on all queued widgets
+        void flushShadows();
 
         //* installs shadow on given widget in a platform independent way
-        void installShadows( QWidget * );
+        /** returns true if the shadow was installed */
+        bool installShadows( QWidget * );
 
         //* uninstalls shadow on given widget in a platform independent way
         void uninstallShadows( QWidget * );
 
-        //* gets the shadow margins for the given widget
-        QMargins shadowMargins( QWidget* ) const;
+        //* hold a reference on the atlas entry for given device pixel ratio, releasing the previous one
+        void acquireShadowTiles( QWidget*, qreal );
+
+        //* release the atlas reference held by given widget, if any
+        void releaseShadowTiles( QWidget* );
+
+        //* gets the shadow margins for the given widget and device pixel ratio
+        QMargins shadowMargins( QWidget*, qreal ) const;
 
         private:
 
         //* helper
         Helper& _helper;
 
+        //* property cache
+        PropertyCache* _propertyCache = nullptr;
+
         //* registered widgets
         QSet<QWidget*> _widgets;
 
         //* managed shadows
         QMap<QWidget*, KWindowShadow*> _shadows;
 
-        //* tileset
-        TileSet _shadowTiles;
+        //* shared shadow textures
+        ShadowAtlas _atlas;
+
+        //* device pixel ratio of the atlas entry used by each shadowed widget
+        QMap<QWidget*, qreal> _devicePixelRatios;
+
+        //* widgets waiting for shadow installation
+        QList<QWidget*> _pendingWidgets;
 
-        //* number of tiles
-        enum { numTiles = 8 };
+        //* timer used to flush pending shadow installations
+        QBasicTimer _flushTimer;
 
-        //* shared shadow tiles
-        QVector<KWindowShadowTile::Ptr> _tiles;
+        //*@name flush statistics
+        //@{
+        int _lastFlushWindowCount = 0;
+        int _maxFlushWindowCount = 0;
+        //@}
 
     };
 
@@ -22,17 +22,23 @@
 #include "feren.h"
 #include "ferenanimations.h"
 #include "ferenframeshadow.h"
+#include "ferenitemviewrowspans.h"
 #include "ferenmdiwindowshadow.h"
 #include "ferenmnemonics.h"
+#include "ferenpropertycache.h"
 #include "ferenpropertynames.h"
+#include "ferenscrollareacache.h"
 #include "ferenshadowhelper.h"
 #include "ferensplitterproxy.h"
+#include "ferentracerecorder.h"
+#include "ferentransitionwidget.h"
 #include "ferenconfigdata.h"
 #include "ferenwidgetexplorer.h"
 #include "ferenwindowmanager.h"
 #include "ferenblurhelper.h"
 
 #include <KColorUtils>
+#include <KIconLoader>
 
 #include <QApplication>
 #include <QCheckBox>
@@ -164,6 +170,9 @@ namespace Feren
         , _frameShadowFactory( new FrameShadowFactory( this ) )
         , _mdiWindowShadowFactory( new MdiWindowShadowFactory( this ) )
         , _splitterFactory( new SplitterFactory( this ) )
+        , _scrollAreaCache( new ScrollAreaCache( this ) )
+        , _propertyCache( new PropertyCache( this ) )
+        , _itemViewRowSpans( new ItemViewRowSpans( this ) )
         , _widgetExplorer( new WidgetExplorer( this ) )
         , _tabBarData( new FerenPrivate::TabBarData( this ) )
         #if FEREN_HAVE_KSTYLE
@@ -172,6 +181,9 @@ namespace Feren
         #endif
     {
 
+        // record style activity if requested
+        TraceRecorder::initialize();
+
         // use DBus connection to update on feren configuration change
         auto dbus = QDBusConnection::sessionBus();
         dbus.connect( QString(),
@@ -179,6 +191,12 @@ namespace Feren
             QStringLiteral( "org.kde.Feren.Style" ),
             QStringLiteral( "reparseConfiguration" ), this, SLOT(configurationChanged()) );
 
+        // update kdeglobals derived settings on global settings change
+        dbus.connect( QString(),
+            QStringLiteral( "/KGlobalSettings" ),
+            QStringLiteral( "org.kde.KGlobalSettings" ),
+            QStringLiteral( "notifyChange" ), this, SLOT(kdeGlobalSettingsChanged(int,int)) );
+
 //         dbus.connect( QString(),
 //             QStringLiteral( "/FerenDecoration" ),
 //             QStringLiteral( "org.kde.Feren.Style" ),
@@ -188,6 +206,33 @@ namespace Feren
         #else
         connect(qApp, &QApplication::paletteChanged, this, &Style::configurationChanged);
         #endif
+        // purge caches on low memory, as reported by low-memory-monitor
+        QDBusConnection::systemBus().connect( QString(),
+            QStringLiteral( "/org/freedesktop/LowMemoryMonitor" ),
+            QStringLiteral( "org.freedesktop.LowMemoryMonitor" ),
+            QStringLiteral( "LowMemoryWarning" ), this, SLOT(lowMemoryWarning(uchar)) );
+
+        // purge caches when the application is not in use
+        connect( qApp, &QGuiApplication::applicationStateChanged, this, &Style::applicationStateChanged );
+
+        // account standard icons with other caches
+        _iconCacheId = _helper->cacheRegistry().registerCache( QStringLiteral( "StandardIcons" ),
+            [this]() { return _iconCacheCost; },
+            [this]() { _iconCache.clear(); _iconCacheCost = 0; return qint64( 0 ); } );
+
+        // recolored icons must follow icon theme changes
+        connect( KIconLoader::global(), &KIconLoader::iconLoaderSettingsChanged, this, [this]() { _helper->clearColoredIconCache(); } );
+
+        // running animations are shown by the widget explorer
+        _widgetExplorer->setAnimations( _animations );
+
+        // share cached style hint properties
+        _shadowHelper->setPropertyCache( _propertyCache );
+        _windowManager->setPropertyCache( _propertyCache );
+
+        // share temporary pixmaps between transitions
+        TransitionWidget::setImagePool( &_helper->imagePool() );
+
         // call the slot directly; this initial call will set up things that also
         // need to be reset when the system palette changes
         loadConfiguration();
@@ -197,6 +242,8 @@ namespace Feren
     //______________________________________________________________
     Style::~Style()
     {
+        _helper->cacheRegistry().unregisterCache( _iconCacheId );
+        TransitionWidget::setImagePool( nullptr );
         delete _shadowHelper;
         delete _helper;
     }
@@ -206,6 +253,11 @@ namespace Feren
     {
         if( !widget ) return;
 
+        const TraceRecorder::Span traceSpan( "style", "polish", widget->metaObject()->className() );
+
+        // cache style hint properties
+        _propertyCache->registerWidget( widget );
+
         // register widget to animations
         _animations->registerWidget( widget );
         _windowManager->registerWidget( widget );
@@ -250,6 +302,9 @@ namespace Feren
             // enable mouse over effects in itemviews' viewport
             itemView->viewport()->setAttribute( Qt::WA_Hover );
 
+            // merge row backgrounds
+            _itemViewRowSpans->registerWidget( itemView );
+
         } else if( auto groupBox = qobject_cast<QGroupBox*>( widget ) )  {
 
             // checkable group boxes
@@ -281,6 +336,7 @@ namespace Feren
         } else if( widget->inherits( "KTextEditor::View" ) ) {
 
             addEventFilter( widget );
+            _scrollAreaCache->registerWidget( widget );
 
         } else if( auto toolButton = qobject_cast<QToolButton*>( widget ) ) {
 
@@ -376,6 +432,7 @@ namespace Feren
 
         // add event filter, to make sure proper background is rendered behind scrollbars
         addEventFilter( scrollArea );
+        _scrollAreaCache->registerWidget( scrollArea );
 
         // force side panels as flat, on option
         if( scrollArea->inherits( "KDEPrivate::KPageListView" ) || scrollArea->inherits( "KDEPrivate::KPageTreeView" ) )
@@ -431,6 +488,8 @@ namespace Feren
     void Style::unpolish( QWidget* widget )
     {
 
+        const TraceRecorder::Span traceSpan( "style", "unpolish", widget ? widget->metaObject()->className():nullptr );
+
         // register widget to animations
         _animations->unregisterWidget( widget );
         _frameShadowFactory->unregisterWidget( widget );
@@ -438,6 +497,9 @@ namespace Feren
         _shadowHelper->unregisterWidget( widget );
         _windowManager->unregisterWidget( widget );
         _splitterFactory->unregisterWidget( widget );
+        _scrollAreaCache->unregisterWidget( widget );
+        _propertyCache->unregisterWidget( widget );
+        _itemViewRowSpans->unregisterWidget( widget );
         _blurHelper->unregisterWidget( widget );
 
         // remove event filter
@@ -812,6 +874,9 @@ namespace Feren
     void Style::drawPrimitive( PrimitiveElement element, const QStyleOption* option, QPainter* painter, const QWidget* widget ) const
     {
 
+        const WidgetExplorer::PaintTimer paintTimer( _widgetExplorer, widget );
+        const TraceRecorder::Span traceSpan( "paint", element );
+
         StylePrimitive fcn;
         switch( element )
         {
@@ -822,6 +887,7 @@ namespace Feren
             case PE_PanelMenu: fcn = &Style::drawPanelMenuPrimitive; break;
             case PE_PanelTipLabel: fcn = &Style::drawPanelTipLabelPrimitive; break;
             case PE_PanelItemViewItem: fcn = &Style::drawPanelItemViewItemPrimitive; break;
+            case PE_PanelItemViewRow: fcn = &Style::drawPanelItemViewRowPrimitive; break;
             case PE_IndicatorCheckBox: fcn = &Style::drawIndicatorCheckBoxPrimitive; break;
             case PE_IndicatorRadioButton: fcn = &Style::drawIndicatorRadioButtonPrimitive; break;
             case PE_IndicatorButtonDropDown: fcn = &Style::drawIndicatorButtonDropDownPrimitive; break;
@@ -864,6 +930,9 @@ namespace Feren
     void Style::drawControl( ControlElement element, const QStyleOption* option, QPainter* painter, const QWidget* widget ) const
     {
 
+        const WidgetExplorer::PaintTimer paintTimer( _widgetExplorer, widget );
+        const TraceRecorder::Span traceSpan( "paint", element );
+
         StyleControl fcn;
 
         #if FEREN_HAVE_KSTYLE
@@ -905,6 +974,7 @@ namespace Feren
             case CE_ToolBoxTabLabel: fcn = &Style::drawToolBoxTabLabelControl; break;
             case CE_ToolBoxTabShape: fcn = &Style::drawToolBoxTabShapeControl; break;
             case CE_DockWidgetTitle: fcn = &Style::drawDockWidgetTitleControl; break;
+            case CE_ItemViewItem: fcn = &Style::drawItemViewItemControl; break;
 
             // fallback
             default: break;
@@ -925,6 +995,9 @@ namespace Feren
     void Style::drawComplexControl( ComplexControl element, const QStyleOptionComplex* option, QPainter* painter, const QWidget* widget ) const
     {
 
+        const WidgetExplorer::PaintTimer paintTimer( _widgetExplorer, widget );
+        const TraceRecorder::Span traceSpan( "paint", element );
+
         StyleComplexControl fcn;
         switch( element )
         {
@@ -959,6 +1032,10 @@ namespace Feren
         const QString &text, QPalette::ColorRole textRole ) const
     {
 
+        // keep track of rendered mnemonics, for repaint on visibility change
+        if( ( flags&Qt::TextShowMnemonic ) && text.contains( QLatin1Char( '&' ) ) )
+        { _mnemonics->registerText( painter, rect ); }
+
         // hide mnemonics if requested
         if( !_mnemonics->enabled() && ( flags&Qt::TextShowMnemonic ) && !( flags&Qt::TextHideMnemonic ) )
         {
@@ -1029,13 +1106,9 @@ namespace Feren
                 if( !( scrollArea && (viewport = scrollArea->viewport()) ) ) break;
 
                 // get scrollarea horizontal and vertical containers
-                QWidget* child( nullptr );
                 QList<QWidget*> children;
-                if( ( child = scrollArea->findChild<QWidget*>( "qt_scrollarea_vcontainer" ) ) && child->isVisible() )
-                { children.append( child ); }
-
-                if( ( child = scrollArea->findChild<QWidget*>( "qt_scrollarea_hcontainer" ) ) && child->isVisible() )
-                { children.append( child ); }
+                foreach( QWidget* child, _scrollAreaCache->containers( scrollArea ) )
+                { if( child->isVisible() ) children.append( child ); }
 
                 if( children.empty() ) break;
                 if( !scrollArea->styleSheet().isEmpty() ) break;
@@ -1081,7 +1154,7 @@ namespace Feren
 
                 } else if( widget->inherits( "KTextEditor::View" ) ) {
 
-                    scrollBars = widget->findChildren<QScrollBar*>();
+                    scrollBars = _scrollAreaCache->scrollBars( widget );
 
                 }
 
@@ -1118,6 +1191,11 @@ namespace Feren
 
             }
 
+            case QEvent::ChildAdded:
+            case QEvent::ChildRemoved:
+            _scrollAreaCache->invalidate( widget );
+            break;
+
             default: break;
 
         }
@@ -1333,12 +1411,58 @@ namespace Feren
 
     }
 
+    //_____________________________________________________________________
+    void Style::kdeGlobalSettingsChanged( int, int )
+    {
+
+        // kdeglobals was changed on disk. Reparse the application's default configuration, which cascades over kdeglobals,
+        // and reload these settings only, rather than the whole style configuration
+        KSharedConfig::openConfig()->reparseConfiguration();
+        loadKdeGlobalSettings();
+
+    }
+
+    //_____________________________________________________________________
+    void Style::loadKdeGlobalSettings()
+    {
+        // the application's own configuration may override kdeglobals
+        const KConfigGroup kdeGroup( KSharedConfig::openConfig(), "KDE" );
+        _showIconsInMenuItems = kdeGroup.readEntry( "ShowIconsInMenuItems", true );
+        _showIconsOnPushButtons = kdeGroup.readEntry( "ShowIconsOnPushButtons", true );
+    }
+
+    //_____________________________________________________________________
+    void Style::applicationStateChanged( Qt::ApplicationState state )
+    { if( state != Qt::ApplicationActive ) _helper->cacheRegistry().purge(); }
+
+    //_____________________________________________________________________
+    void Style::lowMemoryWarning( uchar level )
+    { if( level > 0 ) _helper->cacheRegistry().purge(); }
+
+    //_____________________________________________________________________
+    qint64 Style::iconCost( const QIcon& icon )
+    {
+        // icons do not expose their memory use. Count 32 bits per pixel for each available size
+        qint64 cost = 0;
+        for( const QSize& size : icon.availableSizes() )
+        { cost += qint64( size.width() )*size.height()*4; }
+
+        return cost;
+    }
+
     //____________________________________________________________________
     QIcon Style::standardIconImplementation( StandardPixmap standardPixmap, const QStyleOption* option, const QWidget* widget ) const
     {
 
         // lookup cache
-        if( _iconCache.contains( standardPixmap ) ) return _iconCache.value( standardPixmap );
+        const auto iter( _iconCache.constFind( standardPixmap ) );
+        if( iter != _iconCache.constEnd() )
+        {
+            _helper->cacheRegistry().hit( _iconCacheId );
+            return iter.value();
+        }
+
+        _helper->cacheRegistry().miss( _iconCacheId );
 
         QIcon icon;
         switch( standardPixmap )
@@ -1370,6 +1494,8 @@ namespace Feren
 
         } else {
             const_cast<IconCache*>(&_iconCache)->insert( standardPixmap, icon );
+            _iconCacheCost += iconCost( icon );
+            _helper->cacheRegistry().inserted( _iconCacheId, _iconCacheCost );
             return icon;
         }
 
@@ -1400,6 +1526,16 @@ namespace Feren
 
         // clear icon cache
         _iconCache.clear();
+        _iconCacheCost = 0;
+        _helper->cacheRegistry().removed( _iconCacheId, 0 );
+
+        // memory budget of all caches. Temporary images may use half of it
+        const qint64 cacheBudget( qint64( StyleConfigData::cacheBudget() )*1024 );
+        _helper->cacheRegistry().setBudget( cacheBudget );
+        _helper->imagePool().setBudget( cacheBudget/2 );
+
+        // kdeglobals settings, used by paint and size code
+        loadKdeGlobalSettings();
 
         // scrollbar buttons
         switch( StyleConfigData::scrollBarAddLineButtons() )
@@ -1420,6 +1556,9 @@ namespace Feren
             case 2: _subLineButtons = DoubleButton; break;
         }
 
+        // cached scrollbar arrow rects depend on button types
+        _animations->scrollBarEngine().invalidateButtonRects();
+
         // frame focus
         if( StyleConfigData::viewDrawFocusIndicator() ) _frameFocusPrimitive = &Style::drawFrameFocusRectPrimitive;
         else _frameFocusPrimitive = &Style::emptyPrimitive;
@@ -1427,6 +1566,7 @@ namespace Feren
         // widget explorer
         _widgetExplorer->setEnabled( StyleConfigData::widgetExplorerEnabled() );
         _widgetExplorer->setDrawWidgetRects( StyleConfigData::drawWidgetRects() );
+        _widgetExplorer->setMode( StyleConfigData::widgetExplorerMode() );
     }
 
     //___________________________________________________________________________________________________________________
@@ -1548,7 +1688,7 @@ namespace Feren
     {
         if( !StyleConfigData::sidePanelDrawFrame() &&
             qobject_cast<const QAbstractScrollArea*>( widget ) &&
-            widget->property( PropertyNames::sidePanelView ).toBool() )
+            _propertyCache->testFlag( widget, PropertyCache::SidePanelView ) )
         {
 
             // adjust margins for sidepanel widgets
@@ -2986,7 +3126,7 @@ namespace Feren
         const qreal opacity( _animations->inputWidgetEngine().frameOpacity( widget ) );
 
         // render
-        if( !StyleConfigData::sidePanelDrawFrame() && widget && widget->property( PropertyNames::sidePanelView ).toBool() )
+        if( !StyleConfigData::sidePanelDrawFrame() && _propertyCache->testFlag( widget, PropertyCache::SidePanelView ) )
         {
 
             const auto outline( _helper->sidePanelOutlineColor( palette, hasFocus, opacity, mode ) );
@@ -3647,6 +3787,9 @@ namespace Feren
         const auto viewItemOption = qstyleoption_cast<const QStyleOptionViewItem*>( option );
         if( !viewItemOption ) return false;
 
+        // already rendered by drawItemViewItemControl, outside of the cell clip
+        if( option == _itemViewItemPanelOption ) return true;
+
         // try cast widget
         const auto abstractItemView = qobject_cast<const QAbstractItemView *>( widget );
 
@@ -3674,6 +3817,32 @@ namespace Feren
         if( enabled ) colorGroup = active ? QPalette::Active : QPalette::Inactive;
         else colorGroup = QPalette::Disabled;
 
+        // merge plain alternate and selection backgrounds of consecutive cells into a single rect per row
+        if( !( mouseOver || hasCustomBackground ) &&
+            ( !hasAlternateBackground || palette.brush( colorGroup, QPalette::AlternateBase ).style() == Qt::SolidPattern ) &&
+            _itemViewRowSpans->isBatched( abstractItemView, painter ) )
+        {
+
+            const QRgb alternateColor( hasAlternateBackground ? palette.color( colorGroup, QPalette::AlternateBase ).rgba() : 0 );
+            const QRgb selectionColor( selected ? palette.color( colorGroup, QPalette::Highlight ).rgba() : 0 );
+            const quint64 key( ( quint64( alternateColor ) << 32 ) | selectionColor );
+            if( _itemViewRowSpans->isCovered( painter, rect, key ) ) return true;
+
+            const QRect span( ItemViewRowSpans::rowSpan( abstractItemView, *viewItemOption, selected ) );
+            _itemViewRowSpans->setSpan( painter, span, key );
+
+            if( hasAlternateBackground )
+            {
+                painter->setPen( Qt::NoPen );
+                painter->setBrush( QColor::fromRgba( alternateColor ) );
+                painter->drawRect( span );
+            }
+
+            if( selected ) _helper->renderSelection( painter, span, QColor::fromRgba( selectionColor ) );
+            return true;
+
+        }
+
         // render alternate background
         if( hasAlternateBackground )
         {
@@ -3717,6 +3886,20 @@ namespace Feren
         return true;
     }
 
+    //___________________________________________________________________________________
+    bool Style::drawPanelItemViewRowPrimitive( const QStyleOption* option, QPainter* painter, const QWidget* widget ) const
+    {
+
+        /*
+        table and tree views fill each cell's row background before calling the delegate.
+        Cells covered by a merged row span already have it, and filling them would paint over the span
+        */
+        const auto abstractItemView = qobject_cast<const QAbstractItemView*>( widget );
+        return _itemViewRowSpans->isBatched( abstractItemView, painter ) &&
+            _itemViewRowSpans->contains( painter, option->rect );
+
+    }
+
     //___________________________________________________________________________________
     bool Style::drawIndicatorCheckBoxPrimitive( const QStyleOption* option, QPainter* painter, const QWidget* widget ) const
     {
@@ -4065,34 +4248,16 @@ namespace Feren
         // tree branches
         if( !StyleConfigData::viewDrawTreeBranchLines() ) return true;
 
-        const auto center( rect.center() );
-        const auto lineColor( KColorUtils::mix( palette.color( QPalette::Base ), palette.color( QPalette::Text ), 0.25 ) );
-        painter->setRenderHint( QPainter::Antialiasing, true );
-        painter->translate( 0.5, 0.5 );
-        painter->setPen( QPen( lineColor, 1 ) );
-        if( state & ( State_Item | State_Children | State_Sibling ) )
-        {
-            const QLineF line( QPointF( center.x(), rect.top() ), QPointF( center.x(), center.y() - expanderAdjust - 1 ) );
-            painter->drawLine( line );
-        }
+        TreeBranches branches;
+        if( state & ( State_Item | State_Children | State_Sibling ) ) branches |= TreeBranchTop;
 
         // The right/left (depending on direction) line gets drawn if we have an item
-        if( state & State_Item )
-        {
-            const QLineF line = reverseLayout ?
-                QLineF( QPointF( rect.left(), center.y() ), QPointF( center.x() - expanderAdjust, center.y() ) ):
-                QLineF( QPointF( center.x() + expanderAdjust, center.y() ), QPointF( rect.right(), center.y() ) );
-            painter->drawLine( line );
-
-        }
+        if( state & State_Item ) branches |= TreeBranchSide;
 
         // The bottom if we have a sibling
-        if( state & State_Sibling )
-        {
-            const QLineF line( QPointF( center.x(), center.y() + expanderAdjust ), QPointF( center.x(), rect.bottom() ) );
-            painter->drawLine( line );
-        }
+        if( state & State_Sibling ) branches |= TreeBranchBottom;
 
+        _helper->renderTreeBranch( painter, rect, _helper->treeLineColor( palette ), branches, expanderAdjust, reverseLayout );
         return true;
     }
 
@@ -4279,7 +4444,7 @@ namespace Feren
 
         } else {
 
-            const bool leftAlign( widget && widget->property( PropertyNames::toolButtonAlignment ).toInt() == Qt::AlignLeft );
+            const bool leftAlign( _propertyCache->testFlag( widget, PropertyCache::ToolButtonAlignLeft ) );
             if( leftAlign ) {
                 const int marginWidth( Metrics::Button_MarginWidth + Metrics::Frame_FrameWidth + 1 );
                 iconRect = QRect( QPoint( contentsRect.left() + marginWidth, contentsRect.top() + (contentsRect.height() - iconSize.height())/2 ), iconSize );
@@ -5773,6 +5938,34 @@ namespace Feren
         return true;
     }
 
+    //___________________________________________________________________________________
+    bool Style::drawItemViewItemControl( const QStyleOption* option, QPainter* painter, const QWidget* widget ) const
+    {
+
+        // cast option and check
+        if( !qstyleoption_cast<const QStyleOptionViewItem*>( option ) ) return false;
+
+        // only views with merged row spans need the panel outside of the cell clip
+        const auto abstractItemView = qobject_cast<const QAbstractItemView*>( widget );
+        if( !_itemViewRowSpans->isBatched( abstractItemView, painter ) ) return false;
+
+        /*
+        the parent style clips painting to the cell rect before rendering the panel,
+        which would cut merged row spans at the first cell's edge.
+        Render the panel here first, and skip it when the parent style asks for it
+        */
+        painter->save();
+        drawPrimitive( PE_PanelItemViewItem, option, painter, widget );
+        painter->restore();
+
+        const QStyleOption* previous( _itemViewItemPanelOption );
+        _itemViewItemPanelOption = option;
+        ParentStyleClass::drawControl( CE_ItemViewItem, option, painter, widget );
+        _itemViewItemPanelOption = previous;
+        return true;
+
+    }
+
     //___________________________________________________________________________________
     bool Style::drawDockWidgetTitleControl( const QStyleOption* option, QPainter* painter, const QWidget* widget ) const
     {
@@ -7067,20 +7260,6 @@ namespace Feren
         #endif
     }
 
-    //____________________________________________________________________
-    bool Style::showIconsInMenuItems() const
-    {
-        const KConfigGroup g(KSharedConfig::openConfig(), "KDE");
-        return g.readEntry("ShowIconsInMenuItems", true);
-    }
-
-    //____________________________________________________________________
-    bool Style::showIconsOnPushButtons() const
-    {
-        const KConfigGroup g(KSharedConfig::openConfig(), "KDE");
-        return g.readEntry("ShowIconsOnPushButtons", true);
-    }
-
     //____________________________________________________________________
     bool Style::isMenuTitle( const QWidget* widget ) const
     {
@@ -7088,25 +7267,26 @@ namespace Feren
         // check widget
         if( !widget ) return false;
 
-        // check property
-        const QVariant property( widget->property( PropertyNames::menuTitle ) );
-        if( property.isValid() ) return property.toBool();
+        // check cached value, either set explicitly or detected earlier
+        const PropertyCache::Flags flags( _propertyCache->flags( widget, PropertyCache::MenuTitle ) );
+        if( flags.testFlag( PropertyCache::MenuTitleKnown ) ) return flags.testFlag( PropertyCache::MenuTitle );
 
         // detect menu toolbuttons
-        QWidget* parent = widget->parentWidget();
-        if( qobject_cast<QMenu*>( parent ) )
+        bool menuTitle( false );
+        if( auto menu = qobject_cast<const QMenu*>( widget->parentWidget() ) )
         {
-            foreach( auto child, parent->findChildren<QWidgetAction*>() )
+            foreach( auto action, menu->actions() )
             {
-                if( child->defaultWidget() != widget ) continue;
-                const_cast<QWidget*>(widget)->setProperty( PropertyNames::menuTitle, true );
-                return true;
+                auto widgetAction( qobject_cast<QWidgetAction*>( action ) );
+                if( !widgetAction || widgetAction->defaultWidget() != widget ) continue;
+                menuTitle = true;
+                break;
             }
 
         }
 
-        const_cast<QWidget*>(widget)->setProperty( PropertyNames::menuTitle, false );
-        return false;
+        _propertyCache->setFlag( widget, PropertyCache::MenuTitle, menuTitle );
+        return menuTitle;
 
     }
 
@@ -7117,9 +7297,9 @@ namespace Feren
         // check widget
         if( !widget ) return false;
 
-        // check property
-        const QVariant property( widget->property( PropertyNames::alteredBackground ) );
-        if( property.isValid() ) return property.toBool();
+        // check cached value, either set explicitly or detected earlier
+        const PropertyCache::Flags flags( _propertyCache->flags( widget, PropertyCache::AlteredBackground ) );
+        if( flags.testFlag( PropertyCache::AlteredBackgroundKnown ) ) return flags.testFlag( PropertyCache::AlteredBackground );
 
         // check if widget is of relevant type
         bool hasAlteredBackground( false );
@@ -7129,7 +7309,7 @@ namespace Feren
         else if( StyleConfigData::dockWidgetDrawFrame() && qobject_cast<const QDockWidget*>( widget ) ) hasAlteredBackground = true;
 
         if( widget->parentWidget() && !hasAlteredBackground ) hasAlteredBackground = this->hasAlteredBackground( widget->parentWidget() );
-        const_cast<QWidget*>(widget)->setProperty( PropertyNames::alteredBackground, hasAlteredBackground );
+        _propertyCache->setFlag( widget, PropertyCache::AlteredBackground, hasAlteredBackground );
         return hasAlteredBackground;
 
     }
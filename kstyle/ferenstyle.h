@@ -53,8 +53,11 @@ namespace Feren
     class Animations;
     class FrameShadowFactory;
     class Helper;
+    class ItemViewRowSpans;
     class MdiWindowShadowFactory;
     class Mnemonics;
+    class PropertyCache;
+    class ScrollAreaCache;
     class ShadowHelper;
     class SplitterFactory;
     class WidgetExplorer;
@@ -154,6 +157,15 @@ namespace Feren
         //* update configuration
         void configurationChanged();
 
+        //* update kdeglobals derived settings
+        void kdeGlobalSettingsChanged( int type, int arg );
+
+        //* purge caches when the application becomes inactive
+        void applicationStateChanged( Qt::ApplicationState );
+
+        //* purge caches on low memory
+        void lowMemoryWarning( uchar level );
+
         //* standard icons
         QIcon standardIconImplementation( StandardPixmap, const QStyleOption*, const QWidget* ) const;
 
@@ -168,6 +180,9 @@ namespace Feren
         //* load configuration
         void loadConfiguration();
 
+        //* read kdeglobals settings used by paint and size code
+        void loadKdeGlobalSettings();
+
         //*@name subelementRect specialized functions
         //@{
 
@@ -267,6 +282,7 @@ namespace Feren
         bool drawPanelMenuPrimitive( const QStyleOption*, QPainter*, const QWidget* ) const;
         bool drawPanelTipLabelPrimitive( const QStyleOption*, QPainter*, const QWidget* ) const;
         bool drawPanelItemViewItemPrimitive( const QStyleOption*, QPainter*, const QWidget* ) const;
+        bool drawPanelItemViewRowPrimitive( const QStyleOption*, QPainter*, const QWidget* ) const;
         bool drawIndicatorCheckBoxPrimitive( const QStyleOption*, QPainter*, const QWidget* ) const;
         bool drawIndicatorRadioButtonPrimitive( const QStyleOption*, QPainter*, const QWidget* ) const;
         bool drawIndicatorButtonDropDownPrimitive( const QStyleOption*, QPainter*, const QWidget* ) const;
@@ -306,6 +322,7 @@ namespace Feren
         bool drawToolBoxTabLabelControl( const QStyleOption*, QPainter*, const QWidget* ) const;
         bool drawToolBoxTabShapeControl( const QStyleOption*, QPainter*, const QWidget* ) const;
         bool drawDockWidgetTitleControl( const QStyleOption*, QPainter*, const QWidget* ) const;
+        bool drawItemViewItemControl( const QStyleOption*, QPainter*, const QWidget* ) const;
 
         //*@}
 
@@ -452,11 +469,16 @@ namespace Feren
         //* return true if one of the widget's parent inherits requested type
         template<typename T> bool hasParent( const QWidget* ) const;
 
+        //* bytes held by an icon, estimated from its available sizes
+        static qint64 iconCost( const QIcon& );
+
         //* return true if icons should be shown in menus
-        bool showIconsInMenuItems() const;
+        bool showIconsInMenuItems() const
+        { return _showIconsInMenuItems; }
 
         //* return true if icons should be shown on buttons
-        bool showIconsOnPushButtons() const;
+        bool showIconsOnPushButtons() const
+        { return _showIconsOnPushButtons; }
 
         //* return true if passed widget is a menu title (KMenu::addTitle)
         bool isMenuTitle( const QWidget* ) const;
@@ -470,6 +492,12 @@ namespace Feren
         ScrollBarButtonType _subLineButtons = SingleButton;
         //@}
 
+        //*@name kdeglobals settings, read in loadKdeGlobalSettings
+        //@{
+        bool _showIconsInMenuItems = true;
+        bool _showIconsOnPushButtons = true;
+        //@}
+
         //* helper
         Helper* _helper = nullptr;
 
@@ -497,6 +525,18 @@ namespace Feren
         //* splitter Factory, to extend splitters hit area
         SplitterFactory* _splitterFactory = nullptr;
 
+        //* scrollbar containers and scrollbars of polished scroll areas
+        ScrollAreaCache* _scrollAreaCache = nullptr;
+
+        //* cached style hint properties
+        PropertyCache* _propertyCache = nullptr;
+
+        //* merged item view row backgrounds
+        ItemViewRowSpans* _itemViewRowSpans = nullptr;
+
+        //* item view option whose panel was already rendered outside of the cell clip
+        mutable const QStyleOption* _itemViewItemPanelOption = nullptr;
+
         //* widget explorer
         WidgetExplorer* _widgetExplorer = nullptr;
 
@@ -507,6 +547,12 @@ namespace Feren
         using IconCache = QHash<StandardPixmap, QIcon>;
         IconCache _iconCache;
 
+        //* bytes held by icon cache
+        mutable qint64 _iconCacheCost = 0;
+
+        //* icon cache id in helper's cache registry
+        int _iconCacheId = -1;
+
         //* pointer to primitive specialized function
         using StylePrimitive = std::function<bool(const Style&, const QStyleOption*, QPainter*, const QWidget*)>;
         StylePrimitive _frameFocusPrimitive;
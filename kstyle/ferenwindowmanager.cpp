@@ -47,6 +47,7 @@
 //////////////////////////////////////////////////////////////////////////////
 
 #include "ferenwindowmanager.h"
+#include "ferenpropertycache.h"
 #include "ferenpropertynames.h"
 #include "ferenhelper.h"
 
@@ -115,7 +116,7 @@ namespace Feren
     //* provide application-wise event filter
     /**
     it us used to unlock dragging and make sure event look is properly restored
-    after a drag has occurred
+    after a drag has occurred. It is only installed while dragging is locked or in progress
     */
     class AppEventFilter: public QObject
     {
@@ -132,6 +133,8 @@ namespace Feren
         bool eventFilter( QObject* object, QEvent* event ) override
         {
 
+            _parent->_appEventFilterCounter.increment();
+
             if( event->type() == QEvent::MouseButtonRelease )
             {
 
@@ -191,9 +194,8 @@ namespace Feren
         QObject( parent )
     {
 
-        // install application wise event filter
+        // create application wise event filter. It gets installed when needed
         _appEventFilter = new AppEventFilter( this );
-        qApp->installEventFilter( _appEventFilter );
 
     }
 
@@ -589,9 +591,18 @@ namespace Feren
     bool WindowManager::isBlackListed( QWidget* widget )
     {
 
-        // check against noAnimations property
-        const auto propertyValue( widget->property( PropertyNames::noWindowGrab ) );
-        if( propertyValue.isValid() && propertyValue.toBool() ) return true;
+        // check against noWindowGrab property
+        if( _propertyCache )
+        {
+
+            if( _propertyCache->testFlag( widget, PropertyCache::NoWindowGrab ) ) return true;
+
+        } else {
+
+            const auto propertyValue( widget->property( PropertyNames::noWindowGrab ) );
+            if( propertyValue.isValid() && propertyValue.toBool() ) return true;
+
+        }
 
         // list-based blacklisted widgets
         const auto appName( qApp->applicationName() );
@@ -810,6 +821,7 @@ namespace Feren
         _globalDragPoint = QPoint();
         _dragAboutToStart = false;
         _dragInProgress = false;
+        updateAppEventFilter();
 
     }
 
@@ -835,7 +847,26 @@ namespace Feren
         }
 
         _dragInProgress = true;
+        updateAppEventFilter();
+
+    }
+
+    //____________________________________________________________
+    void WindowManager::setLocked( bool value )
+    {
+        _locked = value;
+        updateAppEventFilter();
+    }
+
+    //____________________________________________________________
+    void WindowManager::updateAppEventFilter()
+    {
+        const bool needed( _locked || _dragInProgress );
+        if( needed == _appEventFilterInstalled ) return;
 
+        if( needed ) qApp->installEventFilter( _appEventFilter );
+        else qApp->removeEventFilter( _appEventFilter );
+        _appEventFilterInstalled = needed;
     }
 
     //_______________________________________________________
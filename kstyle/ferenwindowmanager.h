@@ -23,6 +23,7 @@
 #include "feren.h"
 #include "ferenconfigdata.h"
 #include "config-feren.h"
+#include "fereninvocationcounter.h"
 
 #include <QEvent>
 
@@ -51,6 +52,8 @@ namespace KWayland
 namespace Feren
 {
 
+    class PropertyCache;
+
     class WindowManager: public QObject
     {
 
@@ -79,6 +82,14 @@ namespace Feren
         //* event filter [reimplemented]
         bool eventFilter( QObject*, QEvent* ) override;
 
+        //* property cache, used to check the window grab property
+        void setPropertyCache( PropertyCache* cache )
+        { _propertyCache = cache; }
+
+        //* application event filter invocations
+        const InvocationCounter& appEventFilterCounter() const
+        { return _appEventFilterCounter; }
+
         protected:
 
         //* timer event,
@@ -189,8 +200,8 @@ namespace Feren
         //*@name lock
         //@{
 
-        void setLocked( bool value )
-        { _locked = value; }
+        //* lock. Application event filter is installed while locked
+        void setLocked( bool );
 
         //* lock
         bool isLocked() const
@@ -198,11 +209,17 @@ namespace Feren
 
         //@}
 
+        //* install or remove application event filter, depending on lock and drag state
+        void updateAppEventFilter();
+
         //* returns first widget matching given class, or nullptr if none
         template<typename T> T findParent( const QWidget* ) const;
 
         private:
 
+        //* property cache
+        PropertyCache* _propertyCache = nullptr;
+
         //* enability
         bool _enabled = true;
 
@@ -300,6 +317,12 @@ namespace Feren
         //* application event filter
         QObject* _appEventFilter = nullptr;
 
+        //* true if application event filter is installed
+        bool _appEventFilterInstalled = false;
+
+        //* application event filter invocations
+        InvocationCounter _appEventFilterCounter;
+
         #if FEREN_HAVE_KWAYLAND
 
         //* The Wayland seat object which needs to be passed to move requests.
@@ -0,0 +1,139 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "ferenboxshadowrenderer.h"
+
+#include <QImage>
+#include <QTest>
+
+#include <cstdlib>
+
+using Feren::BoxShadowRenderer;
+
+Q_DECLARE_METATYPE(BoxShadowRenderer::BlurMethod)
+
+// Benchmarks both blur methods, and checks that they produce matching shadows.
+class BoxShadowRendererBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void render_data();
+    void render();
+
+    void gaussianMatchesBox_data();
+    void gaussianMatchesBox();
+
+private:
+    static void addShadowSizes();
+    static QImage renderShadow(BoxShadowRenderer::BlurMethod method, int radius, qreal dpr);
+};
+
+void BoxShadowRendererBenchmark::addShadowSizes()
+{
+    // Radii of the main shadow for the small and very large shadow sizes.
+    QTest::newRow("small@1x") << 12 << 1.0;
+    QTest::newRow("small@2x") << 12 << 2.0;
+    QTest::newRow("very large@1x") << 24 << 1.0;
+    QTest::newRow("very large@2x") << 24 << 2.0;
+}
+
+QImage BoxShadowRendererBenchmark::renderShadow(BoxShadowRenderer::BlurMethod method, int radius, qreal dpr)
+{
+    BoxShadowRenderer renderer;
+    renderer.setBorderRadius(3);
+    renderer.setBoxSize(BoxShadowRenderer::calculateMinimumBoxSize(radius));
+    renderer.setDevicePixelRatio(dpr);
+    renderer.setBlurMethod(method);
+    renderer.addShadow(QPoint(0, 0), radius, QColor(0, 0, 0, 56));
+    renderer.addShadow(QPoint(0, -3), radius / 2, QColor(0, 0, 0, 26));
+    return renderer.render();
+}
+
+void BoxShadowRendererBenchmark::render_data()
+{
+    QTest::addColumn<int>("radius");
+    QTest::addColumn<qreal>("dpr");
+    QTest::addColumn<BoxShadowRenderer::BlurMethod>("method");
+
+    const QList<QPair<QByteArray, BoxShadowRenderer::BlurMethod>> methods {
+        { QByteArrayLiteral("box"), BoxShadowRenderer::BlurMethod::BoxBlur },
+        { QByteArrayLiteral("gaussian"), BoxShadowRenderer::BlurMethod::GaussianBlur }
+    };
+
+    for (const auto &method : methods) {
+        for (const int radius : { 12, 24 }) {
+            for (const qreal dpr : { 1.0, 2.0 }) {
+                const QByteArray name = method.first + ' ' + QByteArray::number(radius) + '@' + QByteArray::number(dpr) + 'x';
+                QTest::newRow(name.constData()) << radius << dpr << method.second;
+            }
+        }
+    }
+}
+
+void BoxShadowRendererBenchmark::render()
+{
+    QFETCH(int, radius);
+    QFETCH(qreal, dpr);
+    QFETCH(BoxShadowRenderer::BlurMethod, method);
+
+    QImage image;
+    QBENCHMARK {
+        image = renderShadow(method, radius, dpr);
+    }
+
+    QVERIFY(!image.isNull());
+}
+
+void BoxShadowRendererBenchmark::gaussianMatchesBox_data()
+{
+    QTest::addColumn<int>("radius");
+    QTest::addColumn<qreal>("dpr");
+    addShadowSizes();
+}
+
+void BoxShadowRendererBenchmark::gaussianMatchesBox()
+{
+    QFETCH(int, radius);
+    QFETCH(qreal, dpr);
+
+    const QImage box = renderShadow(BoxShadowRenderer::BlurMethod::BoxBlur, radius, dpr);
+    const QImage gaussian = renderShadow(BoxShadowRenderer::BlurMethod::GaussianBlur, radius, dpr);
+    QCOMPARE(gaussian.size(), box.size());
+    QCOMPARE(gaussian.format(), box.format());
+
+    // Three box blur passes approximate a Gaussian blur of the same standard deviation.
+    // Allow for the approximation error, and for box widths being rounded to whole pixels.
+    int maxDifference = 0;
+    qint64 totalDifference = 0;
+    for (int y = 0; y < box.height(); ++y) {
+        const QRgb *boxLine = reinterpret_cast<const QRgb *>(box.constScanLine(y));
+        const QRgb *gaussianLine = reinterpret_cast<const QRgb *>(gaussian.constScanLine(y));
+        for (int x = 0; x < box.width(); ++x) {
+            const int difference = std::abs(qAlpha(boxLine[x]) - qAlpha(gaussianLine[x]));
+            maxDifference = qMax(maxDifference, difference);
+            totalDifference += difference;
+        }
+    }
+
+    const qreal meanDifference = qreal(totalDifference) / (box.width() * box.height());
+    QVERIFY2(maxDifference <= 8, qPrintable(QStringLiteral("max alpha difference: %1").arg(maxDifference)));
+    QVERIFY2(meanDifference <= 1.0, qPrintable(QStringLiteral("mean alpha difference: %1").arg(meanDifference)));
+}
+
+QTEST_GUILESS_MAIN(BoxShadowRendererBenchmark)
+
+#include "ferenboxshadowrendererbenchmark.moc"
@@ -22,9 +22,25 @@
 #include "ferenboxshadowrenderer.h"
 
 // Qt
+#include <QHash>
+#include <QMutex>
 #include <QPainter>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QSharedPointer>
+#include <QThread>
+#include <QThreadPool>
 #include <QtMath>
 
+// std
+#include <functional>
+#include <memory>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace Feren
 {
 
@@ -167,48 +183,200 @@ static inline void boxBlurRowAlpha(const uint8_t *src, uint8_t *dst, int width,
 }
 
 /**
- * Blur the alpha channel of a given image.
+ * Compute the weights of a Gaussian filter, as 16 bit fixed point values.
  *
- * @param image The input image.
  * @param radius The blur radius.
- * @param rect Specifies what part of the image to blur. If nothing is provided, then
- *    the whole alpha channel of the input image will be blurred.
+ * @returns The weights, from left to right. They add up to about 1 << 16.
  **/
-static inline void boxBlurAlpha(QImage &image, int radius, const QRect &rect = {})
+static QVector<quint16> computeGaussianWeights(int radius)
 {
-    if (radius < 2) {
-        return;
+    const qreal stdDev = calculateBlurStdDev(radius);
+    const int halfSize = qCeil(3.0 * stdDev);
+
+    QVector<qreal> gaussian(2 * halfSize + 1);
+    qreal sum = 0;
+    for (int i = -halfSize; i <= halfSize; ++i) {
+        const qreal value = qExp(-(i * i) / (2.0 * stdDev * stdDev));
+        gaussian[i + halfSize] = value;
+        sum += value;
     }
 
-    const QVector<BoxLobes> lobes = computeLobes(radius);
+    // Tails that round to zero are dropped, keeping the kernel symmetric.
+    int trim = 0;
+    while (trim < halfSize && qRound(gaussian.at(trim) / sum * 65536.0) == 0) {
+        ++trim;
+    }
 
-    const QRect blurRect = rect.isNull() ? image.rect() : rect;
+    QVector<quint16> weights;
+    weights.reserve(gaussian.size() - 2 * trim);
+    for (int i = trim; i < gaussian.size() - trim; ++i) {
+        weights.append(quint16(qMin(65535, qRound(gaussian.at(i) / sum * 65536.0))));
+    }
+    return weights;
+}
 
-    const int alphaOffset = QSysInfo::ByteOrder == QSysInfo::BigEndian ? 0 : 3;
-    const int width = blurRect.width();
-    const int height = blurRect.height();
-    const int rowStride = image.bytesPerLine();
-    const int pixelStride = image.depth() >> 3;
-
-    const int bufferStride = qMax(width, height) * pixelStride;
-    QScopedPointer<uint8_t, QScopedPointerArrayDeleter<uint8_t> > buf(new uint8_t[2 * bufferStride]);
-    uint8_t *buf1 = buf.data();
-    uint8_t *buf2 = buf1 + bufferStride;
+/**
+ * Precomputed parameters of the blur filters for a given blur radius.
+ **/
+struct BlurKernel
+{
+    QVector<BoxLobes> lobes;  ///< Params of the three box filters.
+    QVector<quint16> weights; ///< Weights of the Gaussian filter.
+};
+
+/**
+ * Maximum number of blur kernels kept in cache.
+ **/
+static const int s_maximumCachedKernels = 32;
+
+/**
+ * Find or compute the blur kernel for a given blur radius and device pixel ratio.
+ *
+ * Kernels are shared between renderers, and between threads.
+ *
+ * @param radius The blur radius.
+ * @param dpr The device pixel ratio.
+ * @returns The kernel, or null if the scaled radius is too small for blurring.
+ **/
+static QSharedPointer<const BlurKernel> findBlurKernel(int radius, qreal dpr)
+{
+    const int scaledRadius = qRound(radius * dpr);
+    if (scaledRadius < 2) {
+        return {};
+    }
+
+    static QMutex mutex;
+    static QHash<QPair<int, qreal>, QSharedPointer<const BlurKernel>> kernels;
+
+    QMutexLocker locker(&mutex);
 
-    // Blur the image in horizontal direction.
-    for (int i = 0; i < height; ++i) {
-        uint8_t *row = image.scanLine(blurRect.y() + i) + blurRect.x() * pixelStride + alphaOffset;
-        boxBlurRowAlpha(row, buf1, width, pixelStride, rowStride, lobes[0], false, false);
-        boxBlurRowAlpha(buf1, buf2, width, pixelStride, rowStride, lobes[1], false, false);
-        boxBlurRowAlpha(buf2, row, width, pixelStride, rowStride, lobes[2], false, false);
+    // Only a handful of radii and scales are ever used, so simply start over if that is not the case.
+    // Kernels still in use are kept alive by their users.
+    if (kernels.size() >= s_maximumCachedKernels && !kernels.contains(qMakePair(radius, dpr))) {
+        kernels.clear();
     }
 
-    // Blur the image in vertical direction.
-    for (int i = 0; i < width; ++i) {
-        uint8_t *column = image.scanLine(blurRect.y()) + (blurRect.x() + i) * pixelStride + alphaOffset;
-        boxBlurRowAlpha(column, buf1, height, pixelStride, rowStride, lobes[0], true, false);
-        boxBlurRowAlpha(buf1, buf2, height, pixelStride, rowStride, lobes[1], false, false);
-        boxBlurRowAlpha(buf2, column, height, pixelStride, rowStride, lobes[2], false, true);
+    QSharedPointer<const BlurKernel> &kernel = kernels[qMakePair(radius, dpr)];
+    if (!kernel) {
+        QSharedPointer<BlurKernel> newKernel(new BlurKernel);
+        newKernel->lobes = computeLobes(scaledRadius);
+        newKernel->weights = computeGaussianWeights(scaledRadius);
+        kernel = newKernel;
+    }
+
+    return kernel;
+}
+
+/**
+ * Scratch buffers used while blurring, kept per thread so that bands can be
+ * blurred concurrently without allocating.
+ **/
+struct BlurScratch
+{
+    std::vector<uint8_t> box;
+    std::vector<uint16_t> padded;
+    std::vector<uint16_t> sums;
+};
+
+static BlurScratch &blurScratch()
+{
+    static thread_local BlurScratch scratch;
+    return scratch;
+}
+
+/**
+ * Process a row with a Gaussian filter.
+ *
+ * Values are spread over 16 bits and multiplied by the 16 bit weights keeping
+ * the high half, so that eight values can be processed at once with SSE2.
+ * The scalar fallback produces the exact same results.
+ *
+ * @param line The start of the row. The result is written in place.
+ * @param length The length of the row, in pixels.
+ * @param step The number of bytes from one alpha value to the next alpha value.
+ * @param weights The weights of the Gaussian filter.
+ * @param scratch Scratch buffers.
+ **/
+static void gaussianBlurRowAlpha(uint8_t *line, int length, int step, const QVector<quint16> &weights, BlurScratch &scratch)
+{
+    const int size = weights.size();
+    const int halfSize = size / 2;
+
+    // Gather the row into a contiguous buffer, repeating edge values.
+    scratch.padded.resize(length + size);
+    uint16_t *padded = scratch.padded.data();
+    for (int i = 0; i < length + size - 1; ++i) {
+        const int source = qBound(0, i - halfSize, length - 1);
+        padded[i] = uint16_t(line[source * step] << 8);
+    }
+
+    scratch.sums.assign(length, 0);
+    uint16_t *sums = scratch.sums.data();
+
+    for (int k = 0; k < size; ++k) {
+        const uint16_t weight = weights.at(k);
+        const uint16_t *in = padded + k;
+        int x = 0;
+
+#if defined(__SSE2__)
+        const __m128i weightVector = _mm_set1_epi16(short(weight));
+        for (; x + 8 <= length; x += 8) {
+            const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + x));
+            const __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i *>(sums + x));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(sums + x), _mm_adds_epu16(current, _mm_mulhi_epu16(values, weightVector)));
+        }
+#endif
+
+        for (; x < length; ++x) {
+            sums[x] = uint16_t(qMin(65535u, sums[x] + ((uint32_t(in[x]) * weight) >> 16)));
+        }
+    }
+
+    for (int x = 0; x < length; ++x) {
+        line[x * step] = uint8_t(qMin(255, (sums[x] + 128) >> 8));
+    }
+}
+
+/**
+ * Blur a band of rows or columns of the alpha channel of an image.
+ *
+ * @param bits The image data.
+ * @param rowStride The number of bytes from one row to the next row.
+ * @param pixelStride The number of bytes from one pixel to the next pixel.
+ * @param blurRect The part of the image to blur.
+ * @param kernel The blur kernel.
+ * @param method The blur method.
+ * @param orientation Qt::Horizontal to blur rows, Qt::Vertical to blur columns.
+ * @param first The first row or column of the band, relative to blurRect.
+ * @param last The row or column after the last one of the band, relative to blurRect.
+ **/
+static void blurBandAlpha(uint8_t *bits, int rowStride, int pixelStride, const QRect &blurRect,
+                          const BlurKernel &kernel, BoxShadowRenderer::BlurMethod method,
+                          Qt::Orientation orientation, int first, int last)
+{
+    const int alphaOffset = QSysInfo::ByteOrder == QSysInfo::BigEndian ? 0 : 3;
+    const bool horizontal = orientation == Qt::Horizontal;
+    const int length = horizontal ? blurRect.width() : blurRect.height();
+
+    BlurScratch &scratch = blurScratch();
+
+    const int bufferStride = length * pixelStride;
+    scratch.box.resize(2 * bufferStride);
+    uint8_t *buf1 = scratch.box.data();
+    uint8_t *buf2 = buf1 + bufferStride;
+
+    for (int i = first; i < last; ++i) {
+        uint8_t *line = horizontal
+            ? bits + (blurRect.y() + i) * rowStride + blurRect.x() * pixelStride + alphaOffset
+            : bits + blurRect.y() * rowStride + (blurRect.x() + i) * pixelStride + alphaOffset;
+
+        if (method == BoxShadowRenderer::BlurMethod::GaussianBlur) {
+            gaussianBlurRowAlpha(line, length, horizontal ? pixelStride : rowStride, kernel.weights, scratch);
+        } else {
+            boxBlurRowAlpha(line, buf1, length, pixelStride, rowStride, kernel.lobes[0], !horizontal, false);
+            boxBlurRowAlpha(buf1, buf2, length, pixelStride, rowStride, kernel.lobes[1], false, false);
+            boxBlurRowAlpha(buf2, line, length, pixelStride, rowStride, kernel.lobes[2], false, !horizontal);
+        }
     }
 }
 
@@ -242,49 +410,169 @@ static inline void mirrorTopLeftQuadrant(QImage &image)
     }
 }
 
-static void renderShadow(QPainter *painter, const QRect &rect, qreal borderRadius, const QPoint &offset, int radius, const QColor &color)
+/**
+ * Minimum number of pixels in the shadow texture for the work to be spread across threads.
+ *
+ * Below that, handing tasks over to other threads costs more than it saves.
+ **/
+static const int s_minimumConcurrentArea = 128 * 128;
+
+/**
+ * Minimum number of rows or columns blurred by a single task.
+ **/
+static const int s_minimumBandSize = 32;
+
+static QThreadPool *shadowThreadPool()
 {
-    const QSize inflation = calculateBlurExtent(radius);
-    const QSize size = rect.size() + 2 * inflation;
+    static QThreadPool pool;
+    static const bool initialized = [] {
+        pool.setMaxThreadCount(qBound(1, QThread::idealThreadCount() - 1, 3));
+        return true;
+    }();
+    Q_UNUSED(initialized)
+    return &pool;
+}
+
+class ShadowTask : public QRunnable
+{
+public:
+    ShadowTask(const std::function<void()> &function, QSemaphore *done)
+        : m_function(function)
+        , m_done(done)
+    {
+        setAutoDelete(false);
+    }
+
+    void run() override
+    {
+        m_function();
+        m_done->release();
+    }
+
+private:
+    std::function<void()> m_function;
+    QSemaphore *m_done;
+};
+
+/**
+ * Run independent tasks and wait for all of them to complete.
+ *
+ * Tasks that were not picked up by the thread pool by the time the calling
+ * thread is done with its own share are run by the calling thread, so this
+ * never waits on a busy pool.
+ *
+ * @param tasks The tasks.
+ * @param concurrent Whether tasks may run on other threads.
+ **/
+static void runTasks(const QVector<std::function<void()>> &tasks, bool concurrent)
+{
+    if (!concurrent || tasks.size() < 2) {
+        for (const std::function<void()> &task : tasks) {
+            task();
+        }
+        return;
+    }
+
+    QThreadPool *pool = shadowThreadPool();
+    QSemaphore done;
+
+    std::vector<std::unique_ptr<ShadowTask>> pending;
+    pending.reserve(tasks.size() - 1);
+    for (int i = 1; i < tasks.size(); ++i) {
+        pending.emplace_back(new ShadowTask(tasks.at(i), &done));
+        pool->start(pending.back().get());
+    }
+
+    tasks.first()();
+
+    for (const std::unique_ptr<ShadowTask> &task : pending) {
+        if (pool->tryTake(task.get())) {
+            task->run();
+        }
+    }
+
+    done.acquire(int(pending.size()));
+}
+
+/**
+ * Split rows or columns into bands, each blurred by its own task.
+ *
+ * @param count The number of rows or columns.
+ * @param concurrent Whether tasks may run on other threads.
+ * @returns The band boundaries, starting with 0 and ending with @p count.
+ **/
+static QVector<int> computeBands(int count, bool concurrent)
+{
+    const int maximumBands = concurrent ? shadowThreadPool()->maxThreadCount() + 1 : 1;
+    const int bandCount = qBound(1, count / s_minimumBandSize, maximumBands);
 
-    const qreal dpr = painter->device()->devicePixelRatioF();
+    QVector<int> bands;
+    bands.reserve(bandCount + 1);
+    for (int i = 0; i <= bandCount; ++i) {
+        bands.append(count * i / bandCount);
+    }
+    return bands;
+}
 
-    QImage shadow(size * dpr, QImage::Format_ARGB32_Premultiplied);
-    shadow.setDevicePixelRatio(dpr);
-    shadow.fill(Qt::transparent);
+struct ShadowLayer
+{
+    QImage image;       ///< the shadow texture
+    QRect boxRect;      ///< the box, in shadow texture coordinates
+    QRect blurRect;     ///< the quadrant to blur, in device pixels
+    QRect targetRect;   ///< where to draw the texture, in canvas coordinates
+    qreal borderRadius; ///< the radius of box' corners
+    QColor color;       ///< the color of the shadow
+    QSharedPointer<const BlurKernel> kernel; ///< the blur kernel, null if there is nothing to blur
+};
 
-    QRect boxRect(QPoint(0, 0), rect.size());
-    boxRect.moveCenter(QRect(QPoint(0, 0), size).center());
+static ShadowLayer createShadowLayer(const QRect &rect, qreal borderRadius, const QPoint &offset, int radius, const QColor &color, qreal dpr)
+{
+    const QSize inflation = calculateBlurExtent(radius);
+    const QSize size = rect.size() + 2 * inflation;
 
-    const qreal xRadius = 2.0 * borderRadius / boxRect.width();
-    const qreal yRadius = 2.0 * borderRadius / boxRect.height();
+    ShadowLayer layer;
+    layer.image = QImage(size * dpr, QImage::Format_ARGB32_Premultiplied);
+    layer.image.setDevicePixelRatio(dpr);
 
-    QPainter shadowPainter;
-    shadowPainter.begin(&shadow);
-    shadowPainter.setRenderHint(QPainter::Antialiasing);
-    shadowPainter.setPen(Qt::NoPen);
-    shadowPainter.setBrush(Qt::black);
-    shadowPainter.drawRoundedRect(boxRect, xRadius, yRadius);
-    shadowPainter.end();
+    layer.boxRect = QRect(QPoint(0, 0), rect.size());
+    layer.boxRect.moveCenter(QRect(QPoint(0, 0), size).center());
 
     // Because the shadow texture is symmetrical, that's enough to blur
     // only the top-left quadrant and then mirror it.
-    const QRect blurRect(0, 0, qCeil(shadow.width() * 0.5), qCeil(shadow.height() * 0.5));
-    const int scaledRadius = qRound(radius * dpr);
-    boxBlurAlpha(shadow, scaledRadius, blurRect);
-    mirrorTopLeftQuadrant(shadow);
+    layer.blurRect = QRect(0, 0, qCeil(layer.image.width() * 0.5), qCeil(layer.image.height() * 0.5));
+
+    layer.targetRect = layer.image.rect();
+    layer.targetRect.setSize(layer.targetRect.size() / dpr);
+    layer.targetRect.moveCenter(rect.center() + offset);
+
+    layer.borderRadius = borderRadius;
+    layer.kernel = findBlurKernel(radius, dpr);
+    layer.color = color;
+    return layer;
+}
+
+static void rasterizeShadowLayer(ShadowLayer &layer)
+{
+    layer.image.fill(Qt::transparent);
+
+    const qreal xRadius = 2.0 * layer.borderRadius / layer.boxRect.width();
+    const qreal yRadius = 2.0 * layer.borderRadius / layer.boxRect.height();
+
+    QPainter painter(&layer.image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(Qt::black);
+    painter.drawRoundedRect(layer.boxRect, xRadius, yRadius);
+}
+
+static void finishShadowLayer(ShadowLayer &layer)
+{
+    mirrorTopLeftQuadrant(layer.image);
 
     // Give the shadow a tint of the desired color.
-    shadowPainter.begin(&shadow);
-    shadowPainter.setCompositionMode(QPainter::CompositionMode_SourceIn);
-    shadowPainter.fillRect(shadow.rect(), color);
-    shadowPainter.end();
-
-    // Actually, present the shadow.
-    QRect shadowRect = shadow.rect();
-    shadowRect.setSize(shadowRect.size() / dpr);
-    shadowRect.moveCenter(rect.center() + offset);
-    painter->drawImage(shadowRect, shadow);
+    QPainter painter(&layer.image);
+    painter.setCompositionMode(QPainter::CompositionMode_SourceIn);
+    painter.fillRect(layer.image.rect(), layer.color);
 }
 
 void BoxShadowRenderer::setBoxSize(const QSize &size)
@@ -302,6 +590,11 @@ void BoxShadowRenderer::setDevicePixelRatio(qreal dpr)
     m_dpr = dpr;
 }
 
+void BoxShadowRenderer::setBlurMethod(BlurMethod method)
+{
+    m_blurMethod = method;
+}
+
 void BoxShadowRenderer::addShadow(const QPoint &offset, int radius, const QColor &color)
 {
     Shadow shadow = {};
@@ -330,9 +623,64 @@ QImage BoxShadowRenderer::render() const
     QRect boxRect(QPoint(0, 0), m_boxSize);
     boxRect.moveCenter(QRect(QPoint(0, 0), canvasSize).center());
 
-    QPainter painter(&canvas);
+    QVector<ShadowLayer> layers;
+    layers.reserve(m_shadows.size());
     for (const Shadow &shadow : qAsConst(m_shadows)) {
-        renderShadow(&painter, boxRect, m_borderRadius, shadow.offset, shadow.radius, shadow.color);
+        layers.append(createShadowLayer(boxRect, m_borderRadius, shadow.offset, shadow.radius, shadow.color, m_dpr));
+    }
+
+    // Layers are independent, and so are rows and columns within a blur pass.
+    // Each step below runs as a batch of tasks, and the layers are composed in order at the end.
+    const bool concurrent = canvas.width() * canvas.height() >= s_minimumConcurrentArea;
+    QVector<std::function<void()>> tasks;
+
+    for (ShadowLayer &layer : layers) {
+        tasks.append([&layer] { rasterizeShadowLayer(layer); });
+    }
+    runTasks(tasks, concurrent);
+
+    // Image data is accessed directly while blurring, so that no thread ever detaches a shared image.
+    QVector<uint8_t *> bits;
+    bits.reserve(layers.size());
+    for (ShadowLayer &layer : layers) {
+        bits.append(layer.image.bits());
+    }
+
+    const BlurMethod method = m_blurMethod;
+    for (const Qt::Orientation orientation : {Qt::Horizontal, Qt::Vertical}) {
+        tasks.clear();
+        for (int i = 0; i < layers.size(); ++i) {
+            const ShadowLayer &layer = layers.at(i);
+            if (!layer.kernel) {
+                continue;
+            }
+
+            const BlurKernel *kernel = layer.kernel.data();
+            uint8_t *layerBits = bits.at(i);
+            const QRect blurRect = layer.blurRect;
+            const int rowStride = layer.image.bytesPerLine();
+            const int pixelStride = layer.image.depth() >> 3;
+            const QVector<int> bands = computeBands(orientation == Qt::Horizontal ? blurRect.height() : blurRect.width(), concurrent);
+            for (int band = 1; band < bands.size(); ++band) {
+                const int first = bands.at(band - 1);
+                const int last = bands.at(band);
+                tasks.append([kernel, layerBits, blurRect, rowStride, pixelStride, method, orientation, first, last] {
+                    blurBandAlpha(layerBits, rowStride, pixelStride, blurRect, *kernel, method, orientation, first, last);
+                });
+            }
+        }
+        runTasks(tasks, concurrent);
+    }
+
+    tasks.clear();
+    for (ShadowLayer &layer : layers) {
+        tasks.append([&layer] { finishShadowLayer(layer); });
+    }
+    runTasks(tasks, concurrent);
+
+    QPainter painter(&canvas);
+    for (const ShadowLayer &layer : qAsConst(layers)) {
+        painter.drawImage(layer.targetRect, layer.image);
     }
     painter.end();
 
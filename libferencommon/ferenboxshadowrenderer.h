@@ -35,6 +35,14 @@ class FERENCOMMON_EXPORT BoxShadowRenderer
 public:
     // Compiler generated constructors & destructor are fine.
 
+    /**
+     * The method used to blur shadows.
+     **/
+    enum class BlurMethod {
+        BoxBlur,      ///< Three box blur passes, approximating a Gaussian blur.
+        GaussianBlur, ///< Separable Gaussian blur. Smoother, but slower.
+    };
+
     /**
      * Set the size of the box.
      * @param size The size of the box.
@@ -53,6 +61,12 @@ public:
      **/
     void setDevicePixelRatio(qreal dpr);
 
+    /**
+     * Set the method used to blur shadows.
+     * @param method The blur method. Defaults to BlurMethod::BoxBlur.
+     **/
+    void setBlurMethod(BlurMethod method);
+
     /**
      * Add a shadow.
      * @param offset The offset of the shadow.
@@ -92,6 +106,7 @@ private:
     QSize m_boxSize;
     qreal m_borderRadius = 0.0;
     qreal m_dpr = 1.0;
+    BlurMethod m_blurMethod = BlurMethod::BoxBlur;
 
     struct Shadow {
         QPoint offset;